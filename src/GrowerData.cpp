@@ -7,18 +7,100 @@
 
 #include "GrowerData.h"
 
+#include <maya/MArgList.h>
+
 const MTypeId GrowerData::id( 0x80777 );
 const MString GrowerData::typeName( "GrowerData" );
 
+// Scene file layout. Bump the version whenever the layout changes, data 
+// written by an older version is discarded (and therefore regrown).
+#define GROWER_DATA_MAGIC	0x52575247 // 'GRWR'
+#define GROWER_DATA_VERSION	3
+
+//////////////////////////////////////////////////////////////////////////
+// Binary encoding helpers
+//
+//	Indices are written as variable-length integers (7 bits per byte) and
+//	whenever they follow each other closely, as the difference with the 
+//	previous one, which keeps most of them to one or two bytes.
+//////////////////////////////////////////////////////////////////////////
+
+template< class T >
+static void WriteRaw( std::ostream& out, const T& value ) {
+	out.write( (const char*)&value, sizeof( T ) );
+}
+
+template< class T >
+static bool ReadRaw( std::istream& in, T& value ) {
+	in.read( (char*)&value, sizeof( T ) );
+	return !in.fail();
+}
+
+static void WriteVarUInt( std::ostream& out, MUint64 value ) {
+	unsigned char buffer[ 10 ];
+	size_t length = 0;
+	do {
+		unsigned char byte = (unsigned char)( value & 0x7f );
+		value >>= 7;
+		if ( value != 0 ) byte |= 0x80;
+		buffer[ length++ ] = byte;
+	} while( value != 0 );
+	out.write( (const char*)buffer, length );
+}
+
+static bool ReadVarUInt( std::istream& in, MUint64& value ) {
+	value = 0;
+	for( unsigned shift = 0; shift < 64; shift += 7 ) {
+		const int byte = in.get();
+		if ( byte == std::istream::traits_type::eof() ) return false;
+		value |= (MUint64)( byte & 0x7f ) << shift;
+		if ( ( byte & 0x80 ) == 0 ) return true;
+	}
+	return false;
+}
+
+// signed differences are zig-zag encoded so that small negative values 
+// also take few bytes
+static MUint64 ZigZag( MUint64 delta ) {
+	return ( delta << 1 ) ^ ( (MUint64)0 - ( delta >> 63 ) );
+}
+
+static MUint64 UnZigZag( MUint64 zigzag ) {
+	return ( zigzag >> 1 ) ^ ( (MUint64)0 - ( zigzag & 1 ) );
+}
+
+static void WriteVarDelta( std::ostream& out, MUint64 value, MUint64 previous ) {
+	WriteVarUInt( out, ZigZag( value - previous ) );
+}
+
+static bool ReadVarDelta( std::istream& in, MUint64& value, MUint64 previous ) {
+	MUint64 zigzag;
+	if ( !ReadVarUInt( in, zigzag ) ) return false;
+	value = previous + UnZigZag( zigzag );
+	return true;
+}
+
+static void WriteFloats( std::ostream& out, const std::vector< float >& values ) {
+	if ( !values.empty() ) {
+		out.write( (const char*)&values[ 0 ], values.size() * sizeof( float ) );
+	}
+}
+
+static bool ReadFloats( std::istream& in, std::vector< float >& values ) {
+	if ( !values.empty() ) {
+		in.read( (char*)&values[ 0 ], values.size() * sizeof( float ) );
+	}
+	return !in.fail();
+}
+
 //////////////////////////////////////////////////////////////////////////
 // GrowerData::GrowerData()
 //////////////////////////////////////////////////////////////////////////
 
 GrowerData::GrowerData() {
-	m_cachedSearchRadius = -1;
-	m_cachedKillRadius = -1;
-	m_cachedNumNeighbours = -1;
-	m_cachedNodeGrowDist = -1;
+	m_inputHash = 0;
+	m_stateHash = 0;
+	m_stateFromCache = false;
 }
 
 //////////////////////////////////////////////////////////////////////////
@@ -40,7 +122,359 @@ void GrowerData::copy ( const MPxData& other ) {
 #if GROWER_DISPLAY_DEBUG_INFO
 		samples		= _other.samples;
 #endif
+		m_inputHash	= _other.m_inputHash;
+		m_cache		= _other.m_cache;
+		m_state		= _other.m_state;
+		m_stateHash	= _other.m_stateHash;
+		m_stateFromCache = _other.m_stateFromCache;
+	}
+}
+
+//////////////////////////////////////////////////////////////////////////
+// GrowerData::UpdateBounds
+//////////////////////////////////////////////////////////////////////////
+
+void GrowerData::UpdateBounds() {
+	bounds.clear();
+	for( size_t i = 0; i < nodes.Size(); i++ ) {
+		const vec3_t p = nodes.Pos( i );
+		bounds.expand( MPoint( p.x, p.y, p.z ) );
+	}
+}
+
+//////////////////////////////////////////////////////////////////////////
+// GrowerData::Reset
+//
+//	Leaves the object as freshly created, so that the next evaluation of
+//	the Grower regrows the whole network.
+//////////////////////////////////////////////////////////////////////////
+
+void GrowerData::Reset() {
+	nodes.Clear();
+	bounds.clear();
+	m_inputHash = 0;
+	m_cache.Reset();
+	m_state.Reset();
+	m_stateHash = 0;
+	m_stateFromCache = false;
+}
+
+//////////////////////////////////////////////////////////////////////////
+// GrowerData::CacheIsComplete
+//
+//	The log recorded along with a growth stopped before completion only
+//	gets completed by carrying on that very same growth.
+//////////////////////////////////////////////////////////////////////////
+
+bool GrowerData::CacheIsComplete() const {
+	return !m_state.Started() || m_stateFromCache || m_state.result == GR_COMPLETED;
+}
+
+// The log is only stored along with the nodes it grows, not with a
+// growth stopped halfway or the first iterations of one.
+static bool StoreCache( const GrowerData& data ) {
+	return data.CacheIsComplete() && ( !data.m_state.Started() || data.nodes.Size() == data.m_state.nodes.Size() );
+}
+
+//////////////////////////////////////////////////////////////////////////
+// GrowerData::writeBinary (override)
+//
+//	Layout: header, cache settings, node positions and normals (single 
+//	precision), parent of each node relative to its own index, and the 
+//	growth replay cache.
+//////////////////////////////////////////////////////////////////////////
+
+MStatus GrowerData::writeBinary( std::ostream& out ) {
+	const unsigned int magic = GROWER_DATA_MAGIC;
+	const unsigned int version = GROWER_DATA_VERSION;
+	WriteRaw( out, magic );
+	WriteRaw( out, version );
+	WriteRaw( out, m_inputHash );
+
+	const growthCache_t noCache;
+	const growthCache_t& cache = StoreCache( *this ) ? m_cache : noCache;
+
+	WriteRaw( out, cache.searchRadius );
+	WriteRaw( out, cache.killRadius );
+	WriteRaw( out, cache.nodeGrowDist );
+	WriteRaw( out, cache.numNeighbours );
+	WriteRaw( out, cache.algorithm );
+	WriteRaw( out, cache.numSamples );
+
+	WriteVarUInt( out, nodes.Size() );
+	WriteFloats( out, nodes.pos );
+	WriteFloats( out, nodes.surfaceNormal );
+	for( size_t i = 0; i < nodes.Size(); i++ ) {
+		WriteVarUInt( out, nodes.parent[ i ] == INVALID_PARENT ? 0 : i - nodes.parent[ i ] );
+	}
+
+	const size_t numIterations = cache.NumIterations();
+	WriteVarUInt( out, numIterations );
+	for( size_t i = 0; i < numIterations; i++ ) {
+		WriteVarUInt( out, cache.assignmentOffsets[ i + 1 ] - cache.assignmentOffsets[ i ] );
+		WriteVarUInt( out, cache.bannedOffsets[ i + 1 ] - cache.bannedOffsets[ i ] );
+	}
+	// the nodes are written as their difference with the previous one
+	// plus 1, leaving 0 for the killed attraction points (no node)
+	MUint64 prevAttractor = 0, prevNode = 0;
+	for( size_t i = 0; i < cache.assignments.size(); i++ ) {
+		const growthCache_t::assignment_t& assignment = cache.assignments[ i ];
+		WriteVarDelta( out, assignment.attractor, prevAttractor );
+		prevAttractor = assignment.attractor;
+		if ( assignment.node == UINT_MAX ) {
+			WriteVarUInt( out, 0 );
+		} else {
+			WriteVarUInt( out, ZigZag( assignment.node - prevNode ) + 1 );
+			prevNode = assignment.node;
+		}
+	}
+	for( size_t i = 0; i < cache.bannedAliveNodes.size(); i++ ) {
+		WriteVarUInt( out, cache.bannedAliveNodes[ i ] );
+	}
+
+	return out.fail() ? MS::kFailure : MS::kSuccess;
+}
+
+//////////////////////////////////////////////////////////////////////////
+// GrowerData::readBinary (override)
+//////////////////////////////////////////////////////////////////////////
+
+MStatus GrowerData::readBinary( std::istream& in, unsigned length ) {
+	Reset();
+	if ( length == 0 ) {
+		return MS::kSuccess;
+	}
+
+	unsigned int magic, version;
+	if ( !ReadRaw( in, magic ) || magic != GROWER_DATA_MAGIC || !ReadRaw( in, version ) ) {
+		cerr << "GrowerData: unrecognized data" << endl;
+		return MS::kFailure;
+	}
+	if ( version != GROWER_DATA_VERSION ) {
+		// skip the payload, the Grower will regrow the network
+		cerr << "GrowerData: discarding data written by version " << version << endl;
+		in.ignore( length - 2 * sizeof( unsigned int ) );
+		return MS::kSuccess;
+	}
+
+	bool ok = ReadRaw( in, m_inputHash ) &&
+			  ReadRaw( in, m_cache.searchRadius ) &&
+			  ReadRaw( in, m_cache.killRadius ) &&
+			  ReadRaw( in, m_cache.nodeGrowDist ) &&
+			  ReadRaw( in, m_cache.numNeighbours ) &&
+			  ReadRaw( in, m_cache.algorithm ) &&
+			  ReadRaw( in, m_cache.numSamples );
+
+	MUint64 numNodes = 0;
+	ok = ok && ReadVarUInt( in, numNodes ) && numNodes < length;
+	if ( ok ) {
+		nodes.Resize( (size_t)numNodes );
+	}
+	ok = ok && ReadFloats( in, nodes.pos ) && ReadFloats( in, nodes.surfaceNormal );
+	for( size_t i = 0; ok && i < nodes.Size(); i++ ) {
+		// only the root lacks a parent, and parents precede their children
+		MUint64 delta;
+		ok = ReadVarUInt( in, delta ) && delta <= i && ( delta > 0 || i == 0 );
+		if ( ok && delta > 0 ) {
+			nodes.parent[ i ] = (unsigned int)( i - delta );
+		}
+	}
+	if ( ok ) {
+		nodes.LinkChildren();
+		UpdateBounds();
+	}
+
+	MUint64 numIterations = 0;
+	ok = ok && ReadVarUInt( in, numIterations ) && numIterations < length;
+	if ( ok ) {
+		m_cache.assignmentOffsets.resize( (size_t)numIterations + 1 );
+		m_cache.bannedOffsets.resize( (size_t)numIterations + 1 );
+		m_cache.assignmentOffsets[ 0 ] = 0;
+		m_cache.bannedOffsets[ 0 ] = 0;
+	}
+	for( size_t i = 0; ok && i < numIterations; i++ ) {
+		MUint64 numAssignments, numBanned;
+		ok = ReadVarUInt( in, numAssignments ) && ReadVarUInt( in, numBanned ) &&
+			 numAssignments < length && numBanned < length;
+		if ( ok ) {
+			m_cache.assignmentOffsets[ i + 1 ] = m_cache.assignmentOffsets[ i ] + (size_t)numAssignments;
+			m_cache.bannedOffsets[ i + 1 ] = m_cache.bannedOffsets[ i ] + (size_t)numBanned;
+		}
+	}
+	if ( ok ) {
+		m_cache.assignments.resize( m_cache.assignmentOffsets.back() );
+		m_cache.bannedAliveNodes.resize( m_cache.bannedOffsets.back() );
+	}
+	MUint64 prevAttractor = 0, prevNode = 0;
+	for( size_t i = 0; ok && i < m_cache.assignments.size(); i++ ) {
+		MUint64 node = 0;
+		ok = ReadVarDelta( in, prevAttractor, prevAttractor ) && 
+			 ReadVarUInt( in, node ) &&
+			 prevAttractor < m_cache.numSamples;
+		if ( ok && node > 0 ) {
+			prevNode += UnZigZag( node - 1 );
+			ok = prevNode < nodes.Size();
+		}
+		m_cache.assignments[ i ].attractor = (sampleIndex_t)prevAttractor;
+		m_cache.assignments[ i ].node = node > 0 ? (sampleIndex_t)prevNode : UINT_MAX;
+	}
+	for( size_t i = 0; ok && i < m_cache.bannedAliveNodes.size(); i++ ) {
+		MUint64 node;
+		ok = ReadVarUInt( in, node ) && node < nodes.Size();
+		m_cache.bannedAliveNodes[ i ] = (sampleIndex_t)node;
+	}
+
+	if ( !ok ) {
+		cerr << "GrowerData: corrupt data, the network will be regrown" << endl;
+		Reset();
+		return MS::kFailure;
+	}
+	return MS::kSuccess;
+}
+
+//////////////////////////////////////////////////////////////////////////
+// GrowerData::writeASCII (override)
+//
+//	Same contents as the binary layout, written as plain values. The input
+//	hash is split in two 32 bit halves since MArgList has no 64 bit getter.
+//	The version is followed by the number of values after it, so that a
+//	reader can skip the data of a version it doesn't know.
+//////////////////////////////////////////////////////////////////////////
+
+MStatus GrowerData::writeASCII( std::ostream& out ) {
+	const std::streamsize precision = out.precision( 9 );
+
+	const growthCache_t noCache;
+	const growthCache_t& cache = StoreCache( *this ) ? m_cache : noCache;
+
+	const size_t numIterations = cache.NumIterations();
+	const size_t numValues = 8 + 1 + 7 * nodes.Size() + 1 + 2 * numIterations + 2 * cache.assignments.size() + cache.bannedAliveNodes.size();
+
+	out << GROWER_DATA_VERSION << " " << numValues << " ";
+	out << (unsigned int)( m_inputHash >> 32 ) << " " << (unsigned int)( m_inputHash & 0xffffffff ) << " ";
+	out << cache.searchRadius << " " << cache.killRadius << " " << cache.nodeGrowDist << " ";
+	out << cache.numNeighbours << " " << cache.algorithm << " " << cache.numSamples << " ";
+
+	out << nodes.Size() << " ";
+	for( size_t i = 0; i < nodes.Size(); i++ ) {
+		out << nodes.pos[ 3 * i ] << " " << nodes.pos[ 3 * i + 1 ] << " " << nodes.pos[ 3 * i + 2 ] << " ";
+		out << nodes.surfaceNormal[ 3 * i ] << " " << nodes.surfaceNormal[ 3 * i + 1 ] << " " << nodes.surfaceNormal[ 3 * i + 2 ] << " ";
+		out << ( nodes.parent[ i ] == INVALID_PARENT ? -1 : (long)nodes.parent[ i ] ) << " ";
+	}
+
+	out << numIterations << " ";
+	for( size_t i = 0; i < numIterations; i++ ) {
+		out << cache.assignmentOffsets[ i + 1 ] - cache.assignmentOffsets[ i ] << " ";
+		out << cache.bannedOffsets[ i + 1 ] - cache.bannedOffsets[ i ] << " ";
+	}
+	for( size_t i = 0; i < cache.assignments.size(); i++ ) {
+		out << cache.assignments[ i ].attractor << " " << cache.assignments[ i ].node << " ";
+	}
+	for( size_t i = 0; i < cache.bannedAliveNodes.size(); i++ ) {
+		out << cache.bannedAliveNodes[ i ] << " ";
+	}
+
+	out.precision( precision );
+	return out.fail() ? MS::kFailure : MS::kSuccess;
+}
+
+//////////////////////////////////////////////////////////////////////////
+// GrowerData::readASCII (override)
+//////////////////////////////////////////////////////////////////////////
+
+MStatus GrowerData::readASCII( const MArgList& argList, unsigned& idx ) {
+	Reset();
+	const unsigned numArgs = argList.length();
+	if ( idx >= numArgs ) {
+		return MS::kSuccess;
+	}
+
+	MStatus stat;
+	const int version = argList.asInt( idx++, &stat );
+	if ( !stat ) {
+		cerr << "GrowerData: unrecognized data" << endl;
+		return MS::kFailure;
+	}
+	if ( version != GROWER_DATA_VERSION ) {
+		// skip the values, the Grower will regrow the network. Version 1
+		// didn't write their number, but they were all of the data.
+		cerr << "GrowerData: discarding data written by version " << version << endl;
+		const int numValues = version > 1 && idx < numArgs ? argList.asInt( idx++ ) : -1;
+		idx = numValues >= 0 && numValues <= (int)( numArgs - idx ) ? idx + numValues : numArgs;
+		return MS::kSuccess;
+	}
+	idx++; // number of values
+
+	bool ok = idx + 10 <= numArgs;
+	if ( ok ) {
+		const MUint64 hashHi = (MUint64)argList.asDouble( idx++ );
+		const MUint64 hashLo = (MUint64)argList.asDouble( idx++ );
+		m_inputHash = ( hashHi << 32 ) | hashLo;
+		m_cache.searchRadius	= (float)argList.asDouble( idx++ );
+		m_cache.killRadius		= (float)argList.asDouble( idx++ );
+		m_cache.nodeGrowDist	= (float)argList.asDouble( idx++ );
+		m_cache.numNeighbours	= argList.asInt( idx++ );
+		m_cache.algorithm		= argList.asInt( idx++ );
+		m_cache.numSamples		= (unsigned int)argList.asDouble( idx++ );
+
+		const int numNodes = argList.asInt( idx++ );
+		ok = numNodes >= 0 && idx + 7 * (unsigned)numNodes < numArgs;
+		if ( ok ) {
+			nodes.Resize( numNodes );
+		}
+	}
+	for( size_t i = 0; ok && i < nodes.Size(); i++ ) {
+		for( int k = 0; k < 3; k++ ) {
+			nodes.pos[ 3 * i + k ] = (float)argList.asDouble( idx++ );
+		}
+		for( int k = 0; k < 3; k++ ) {
+			nodes.surfaceNormal[ 3 * i + k ] = (float)argList.asDouble( idx++ );
+		}
+		const int parent = argList.asInt( idx++ );
+		ok = parent < (int)i && ( parent >= 0 || i == 0 );
+		if ( parent >= 0 ) {
+			nodes.parent[ i ] = parent;
+		}
+	}
+	if ( ok ) {
+		nodes.LinkChildren();
+		UpdateBounds();
+	}
+
+	const int numIterations = ok ? argList.asInt( idx++ ) : -1;
+	ok = ok && numIterations >= 0 && idx + 2 * (unsigned)numIterations <= numArgs;
+	if ( ok ) {
+		m_cache.assignmentOffsets.resize( numIterations + 1 );
+		m_cache.bannedOffsets.resize( numIterations + 1 );
+		m_cache.assignmentOffsets[ 0 ] = 0;
+		m_cache.bannedOffsets[ 0 ] = 0;
+		for( int i = 0; i < numIterations; i++ ) {
+			m_cache.assignmentOffsets[ i + 1 ] = m_cache.assignmentOffsets[ i ] + argList.asInt( idx++ );
+			m_cache.bannedOffsets[ i + 1 ] = m_cache.bannedOffsets[ i ] + argList.asInt( idx++ );
+		}
+		ok = idx + 2 * m_cache.assignmentOffsets.back() + m_cache.bannedOffsets.back() <= numArgs;
+	}
+	if ( ok ) {
+		m_cache.assignments.resize( m_cache.assignmentOffsets.back() );
+		for( size_t i = 0; i < m_cache.assignments.size(); i++ ) {
+			m_cache.assignments[ i ].attractor = (sampleIndex_t)argList.asDouble( idx++ );
+			m_cache.assignments[ i ].node = (sampleIndex_t)argList.asDouble( idx++ );
+			ok = ok && m_cache.assignments[ i ].attractor < m_cache.numSamples && 
+				 ( m_cache.assignments[ i ].node < nodes.Size() || m_cache.assignments[ i ].node == UINT_MAX );
+		}
+		m_cache.bannedAliveNodes.resize( m_cache.bannedOffsets.back() );
+		for( size_t i = 0; i < m_cache.bannedAliveNodes.size(); i++ ) {
+			m_cache.bannedAliveNodes[ i ] = (sampleIndex_t)argList.asDouble( idx++ );
+			ok = ok && m_cache.bannedAliveNodes[ i ] < nodes.Size();
+		}
+	}
+
+	if ( !ok ) {
+		cerr << "GrowerData: corrupt data, the network will be regrown" << endl;
+		Reset();
+		return MS::kFailure;
 	}
+	return MS::kSuccess;
 }
 
 //////////////////////////////////////////////////////////////////////////
@@ -10,6 +10,7 @@
 
 #include <maya/MPxGeometryData.h>
 #include <maya/MTypeId.h>
+#include <maya/MTypes.h>
 #include <maya/MString.h>
 #include <maya/MPointArray.h>
 #include <maya/MBoundingBox.h>
@@ -17,19 +18,8 @@
 #include <vector>
 
 #include "common.h"
-#include "NearestNeighbors.h"
-
-#define INVALID_PARENT	1 << 30
-struct growerNode_t {
-
-	growerNode_t() : parent( INVALID_PARENT ), trimmed( false ) {}
-
-	MPoint					pos;
-	MVector					surfaceNormal;
-	size_t					parent : 31;
-	bool					trimmed : 1;
-	std::vector< size_t >	children;
-};
+#include "core/GrowerNodes.h"
+#include "core/Colonization.h"
 
 #if GROWER_DISPLAY_DEBUG_INFO
 // Just used to preview the attraction points
@@ -61,6 +51,11 @@ public:
 	virtual MTypeId         typeId() const;
 	virtual MString         name() const;
 
+	virtual MStatus			readASCII( const MArgList& argList, unsigned& idx );
+	virtual MStatus			readBinary( std::istream& in, unsigned length );
+	virtual MStatus			writeASCII( std::ostream& out );
+	virtual MStatus			writeBinary( std::ostream& out );
+
 	//////////////////////////////////////////////////////////////////
 	//
 	// Helper methods
@@ -69,7 +64,12 @@ public:
 
 	static void *	creator();
 
-	bool			hasGeometry() const { return nodes.size() > 0; }
+	bool			hasGeometry() const { return nodes.Size() > 0; }
+	void			Reset();
+	void			UpdateBounds();
+
+	// whether m_cache logs a whole growth, rather than one stopped halfway
+	bool			CacheIsComplete() const;
 
 public:
 	static const MString typeName;
@@ -78,19 +78,21 @@ public:
 #if GROWER_DISPLAY_DEBUG_INFO
 	std::vector< attractionPointVis_t > samples;
 #endif
-	std::vector< growerNode_t > nodes;
+	growerNodes_t nodes;
 	MBoundingBox bounds;
 
-	// cache data
-	std::vector< std::vector<RenderLib::DataStructures::SampleIndex_t> > m_cachedAffectedPoints;
-	std::vector< std::vector<RenderLib::DataStructures::SampleIndex_t> > m_cachedClosestNode;
-	std::vector< std::vector<RenderLib::DataStructures::SampleIndex_t> > m_cachedBannedAliveNodes;
-	std::vector< std::vector<bool> >									 m_cachedActiveAttractors;
+	// hash of the Grower inputs the nodes were grown from, used to tell
+	// whether data loaded from the scene file can be reused as it is.
+	MUint64 m_inputHash;
 
-	float m_cachedSearchRadius;
-	float m_cachedKillRadius;
-	int	  m_cachedNumNeighbours;
-	float m_cachedNodeGrowDist;
+	// growth log, used to replay the growth while the settings don't change
+	growthCache_t m_cache;
 
+	// growth carried on by the Grower as its iterations attribute steps
+	// forward, along with the hash of the inputs it was started from and
+	// whether it replays m_cache. Not stored in the scene.
+	growthState_t m_state;
+	MUint64 m_stateHash;
+	bool m_stateFromCache;
 };
 #endif // GrowerData_h__
@@ -7,12 +7,17 @@
 
 #include "GrowerNode.h"
 #include "GrowerData.h"
-#include "NearestNeighbors.h"
+#include "SampleData.h"
+#include "MayaTaskRunner.h"
+#include "GrowerStats.h"
+#include "core/Colonization.h"
+#include "core/Hash.h"
 
 #include <maya/MPlug.h>
 #include <maya/MDataBlock.h>
 #include <maya/MDataHandle.h>
 #include <maya/MFnNumericAttribute.h>
+#include <maya/MFnEnumAttribute.h>
 #include <maya/MFnTypedAttribute.h>
 #include <maya/MVectorArray.h>
 #include <maya/MFnPointArrayData.h>
@@ -25,9 +30,13 @@
 #include <maya/MFnCompoundAttribute.h>
 #include <maya/MFnVectorArrayData.h>
 #include <maya/MFnMatrixData.h>
+#include <maya/MFnDependencyNode.h>
+#include <maya/MComputation.h>
+#include <maya/MAnimControl.h>
 
 #include <stack>
 #include <set>
+#include <algorithm>
 
 //////////////////////////////////////////////////////////////////////
 //
@@ -62,13 +71,53 @@ MObject		Grower::cacheSolution;
 MObject		Grower::inputSamples;
 MObject		Grower::inputPoints;
 MObject		Grower::inputNormals;
+MObject		Grower::inputSampleData;
 MObject		Grower::inputPosition;
 MObject		Grower::world2Local;
 MObject		Grower::searchRadius;
 MObject		Grower::killRadius;
 MObject		Grower::growDist;
 MObject		Grower::maxNeighbors;
+MObject		Grower::algorithm;
+MObject		Grower::maxNodes;
+MObject		Grower::timeBudget;
+MObject		Grower::iterations;
 MObject		Grower::aoMeshData;
+MObject		Grower::statComputeTime;
+MObject		Grower::statGrowTime;
+MObject		Grower::statIterations;
+MObject		Grower::statPeakFront;
+MObject		Grower::statKnnQueries;
+MObject		Grower::statBytes;
+
+// Identifies the inputs a GrowerData was grown from
+static MUint64 HashGrowthInputs( const samplePoints_t& samples, 
+								 const MPoint& sourcePos,
+								 const float searchRadius, 
+								 const float killRadius, 
+								 const float nodeGrowDist,
+								 const int maxNeighbors, 
+								 const int algorithm,
+								 const int maxNodes,
+								 const bool cacheGrowth ) {
+	MUint64 hash = HASH_SEED;
+	hash = HashValue( hash, samples.positionsHash );
+	if ( !samples.normals.empty() ) {
+		hash = HashBytes( hash, &samples.normals[ 0 ], samples.normals.size() * sizeof( float ) );
+	}
+	hash = HashValue( hash, sourcePos.x );
+	hash = HashValue( hash, sourcePos.y );
+	hash = HashValue( hash, sourcePos.z );
+	hash = HashValue( hash, searchRadius );
+	hash = HashValue( hash, killRadius );
+	hash = HashValue( hash, nodeGrowDist );
+	hash = HashValue( hash, maxNeighbors );
+	hash = HashValue( hash, algorithm );
+	hash = HashValue( hash, maxNodes );
+	hash = HashValue( hash, cacheGrowth );
+	// never return the "no inputs" value of a freshly created GrowerData
+	return hash != 0 ? hash : 1;
+}
 
 
 MStatus Grower::compute( const MPlug& plug, MDataBlock& data )
@@ -85,17 +134,41 @@ MStatus Grower::compute( const MPlug& plug, MDataBlock& data )
 	MStatus stat;
 	if ( plug == aoMeshData ) {
 
-		MDataHandle inputPointsHandle = data.inputValue( inputSamples, &stat );
-
-		MObject pointArrayObj = inputPointsHandle.child( inputPoints ).data();
-		MFnPointArrayData pointVecData;
-		pointVecData.setObject(pointArrayObj);
-		MPointArray pointVec = pointVecData.array();
+		// the samples are read straight out of the Sampler SampleData when
+		// connected, otherwise they're converted from the point and vector
+		// arrays (as connected by older scenes).
+		const samplePoints_t* samples = NULL;
+		samplePoints_t arraySamples;
+		const SampleData* sampleData = NULL;
+		if ( MPlug( thisMObject(), inputSampleData ).isConnected() ) {
+			sampleData = (const SampleData*)data.inputValue( inputSampleData, &stat ).asPluginData();
+		}
+		if ( sampleData != NULL ) {
+			samples = &sampleData->samples;
+		} else {
+			MDataHandle inputPointsHandle = data.inputValue( inputSamples, &stat );
+
+			MObject pointArrayObj = inputPointsHandle.child( inputPoints ).data();
+			MFnPointArrayData pointVecData;
+			pointVecData.setObject(pointArrayObj);
+			MPointArray pointVec = pointVecData.array();
+
+			MObject normalArrayObj = inputPointsHandle.child( inputNormals ).data();
+			MFnVectorArrayData normalVecData;
+			normalVecData.setObject(normalArrayObj);
+			MVectorArray normalVec = normalVecData.array();
+
+			arraySamples.Resize( pointVec.length() );
+			for( unsigned int i = 0; i < pointVec.length(); i++ ) {
+				arraySamples.SetPos( i, vec3_t( pointVec[ i ].x, pointVec[ i ].y, pointVec[ i ].z ) );
+				const MVector normal = i < normalVec.length() ? normalVec[ i ] : MVector::zero;
+				arraySamples.SetNormal( i, vec3_t( normal.x, normal.y, normal.z ) );
+			}
+			arraySamples.Update( false );
+			samples = &arraySamples;
+		}
 
-		MObject normalArrayObj = inputPointsHandle.child( inputNormals ).data();
-		MFnVectorArrayData normalVecData;
-		normalVecData.setObject(normalArrayObj);
-		MVectorArray normalVec = normalVecData.array();
+		StatTimer computeTimer( "compute", thisMObject() );
 
 		MFnPluginData fnDataCreator;
 		MTypeId tmpid( GrowerData::id );
@@ -114,11 +187,7 @@ MStatus Grower::compute( const MPlug& plug, MDataBlock& data )
 
 		// compute the output values			
 
-		MBoundingBox srcBounds;
-		srcBounds.clear();
-		for( unsigned int i = 0; i < pointVec.length(); i++ ) {
-			srcBounds.expand( pointVec[ i ] );
-		}		
+		const bounds_t& srcBounds = samples->bounds;
 
 		MPoint sourcePos = data.inputValue( Grower::inputPosition ).asFloatVector();
 		MFnMatrixData matrixData( data.inputValue( Grower::world2Local ).data() );
@@ -129,6 +198,10 @@ MStatus Grower::compute( const MPlug& plug, MDataBlock& data )
 		float killRadius   = data.inputValue( Grower::killRadius ).asFloat();
 		float nodeGrowDist = data.inputValue( Grower::growDist ).asFloat();
 		int maxNeighbors   = data.inputValue( Grower::maxNeighbors ).asInt();
+		int algorithm	   = data.inputValue( Grower::algorithm ).asShort();
+		int nodeLimit	   = data.inputValue( Grower::maxNodes ).asInt();
+		float growthBudget = data.inputValue( Grower::timeBudget ).asFloat();
+		int iterationLimit = data.inputValue( Grower::iterations ).asInt();
 
 		// invalidate the cache if the input settings differ too much (note for
 		// the distances we're using the multiplier, not the absolute distance
@@ -136,54 +209,106 @@ MStatus Grower::compute( const MPlug& plug, MDataBlock& data )
 
 		const bool cacheGrowth = data.inputValue(cacheSolution, &stat).asBool();
 
-		bool useCachedSolution = cacheGrowth && 
-								 fabsf(searchRadius - newData->m_cachedSearchRadius) < 1e-1f &&
-								 fabsf(killRadius - newData->m_cachedKillRadius) < 1e-1f &&
-								 maxNeighbors == newData->m_cachedNumNeighbours &&
-								 fabsf(nodeGrowDist - newData->m_cachedNodeGrowDist) < 1e-1f;
-
-		if ( !useCachedSolution )
-		{
-			// we'll regenerate the cache inside the grow method, store the
-			// input parameters here for next time.
-			newData->m_cachedSearchRadius = searchRadius;
-			newData->m_cachedKillRadius = killRadius;
-			newData->m_cachedNumNeighbours = maxNeighbors;
-			newData->m_cachedNodeGrowDist = nodeGrowDist;
+		// the output is stored in the scene, if it was grown from these very
+		// same inputs there's no need to grow it again
+		const MUint64 growthHash = HashGrowthInputs( *samples, sourcePos, searchRadius, killRadius, nodeGrowDist, maxNeighbors, algorithm, nodeLimit, cacheGrowth );
+		const MUint64 inputHash = std::max( HashValue( growthHash, iterationLimit ), (MUint64)1 );
+		if ( newData->hasGeometry() && newData->m_inputHash == inputHash ) {
+			if ( newData != outHandle.asPluginData() ) {
+				outHandle.set( newData );
+			}
+			SetStat( data, statComputeTime, computeTimer.Stop() );
+			data.setClean(plug);
+			return MS::kSuccess;
+		}
+
+		// the growth kept from the previous evaluations is carried on if it
+		// was started from the same inputs, otherwise a new one is started
+		bool useCachedSolution = newData->m_stateFromCache;
+		if ( newData->m_stateHash != growthHash || !newData->m_state.Started() ) {
+			if ( !newData->CacheIsComplete() ) {
+				newData->m_cache.Reset();
+			}
+			useCachedSolution = cacheGrowth && 
+								fabsf(searchRadius - newData->m_cache.searchRadius) < 1e-1f &&
+								fabsf(killRadius - newData->m_cache.killRadius) < 1e-1f &&
+								maxNeighbors == newData->m_cache.numNeighbours &&
+								algorithm == newData->m_cache.algorithm &&
+								fabsf(nodeGrowDist - newData->m_cache.nodeGrowDist) < 1e-1f &&
+								samples->Size() == newData->m_cache.numSamples;
+
+			if ( !useCachedSolution )
+			{
+				// we'll regenerate the cache inside the grow method, store the
+				// input parameters here for next time.
+				newData->m_cache.searchRadius = searchRadius;
+				newData->m_cache.killRadius = killRadius;
+				newData->m_cache.numNeighbours = maxNeighbors;
+				newData->m_cache.algorithm = algorithm;
+				newData->m_cache.nodeGrowDist = nodeGrowDist;
+				newData->m_cache.numSamples = (unsigned int)samples->Size();
+			}
+			newData->m_state.Reset();
+			newData->m_stateHash = growthHash;
+			newData->m_stateFromCache = useCachedSolution;
 		}
 
 		// calculate the scene-sized distance thresholds
-		float maxExtents = (float)std::max( srcBounds.width(), std::max( srcBounds.height(), srcBounds.depth() ) );
+		float maxExtents = (float)std::max( srcBounds.Width(), std::max( srcBounds.Height(), srcBounds.Depth() ) );
 		searchRadius = searchRadius * maxExtents;
 		killRadius	 = killRadius	* maxExtents;
 		nodeGrowDist = nodeGrowDist * maxExtents;
 
 
-		newData->nodes.resize( 0 );
 #if GROWER_DISPLAY_DEBUG_INFO
 		newData->samples.resize( 0 );
 #endif
-		Grow( pointVec, 
-			  normalVec, 
-			  sourcePos, 
-			  searchRadius, 
-			  killRadius, 
-			  maxNeighbors, 
-			  nodeGrowDist, 
-			  useCachedSolution, // we either use the cache, or generate it
-			  newData);
+		StatTimer growTimer( "grow", thisMObject() );
+		growthStats_t growth;
+		const int growthResult = Grow( *samples, 
+									   sourcePos, 
+									   searchRadius, 
+									   killRadius, 
+									   maxNeighbors, 
+									   nodeGrowDist, 
+									   algorithm,
+									   nodeLimit,
+									   growthBudget,
+									   iterationLimit,
+									   useCachedSolution, // we either use the cache, or generate it
+									   newData,
+									   &growth);
+		SetStat( data, statGrowTime, growTimer.Stop() );
 	
-		newData->bounds.clear();
-		for( unsigned int i = 0; i < newData->nodes.size(); i++ ) {
-			newData->bounds.expand( newData->nodes[ i ].pos );
+		newData->UpdateBounds();
+
+		// the nodes grown until the growth was stopped are output as they
+		// are. They only stand for these inputs if the same ones would be
+		// grown again though, otherwise the next evaluation carries on.
+		const bool reproducible = growthResult == GR_COMPLETED || growthResult == GR_NODE_LIMIT || growthResult == GR_ITERATION_LIMIT;
+		newData->m_inputHash = reproducible ? inputHash : 0;
+		if ( growthResult != GR_COMPLETED && growthResult != GR_ITERATION_LIMIT ) {
+			MString msg = MFnDependencyNode( thisMObject() ).name();
+			msg += growthResult == GR_INTERRUPTED ? ": growth interrupted" : 
+				   growthResult == GR_NODE_LIMIT ? ": growth stopped at maxNodes" : ": growth stopped at timeBudget";
+			msg += ", keeping ";
+			msg += (int)newData->nodes.Size();
+			msg += " nodes";
+			MGlobal::displayWarning( msg );
 		}
 
+		SetStat( data, statIterations, (double)growth.iterations );
+		SetStat( data, statPeakFront, (double)growth.peakAliveNodes );
+		SetStat( data, statKnnQueries, (double)growth.knnQueries );
+		SetStat( data, statBytes, (double)( newData->nodes.Bytes() + newData->m_cache.Bytes() + newData->m_state.Bytes() + m_sampleIndex.Bytes() ) );
+
 		// Assign the new data to the outputSurface handle
 
 		if ( newData != outHandle.asPluginData() ) {
 			outHandle.set( newData );
 		}
 
+		SetStat( data, statComputeTime, computeTimer.Stop() );
 		data.setClean(plug);
 		return MS::kSuccess;
 
@@ -224,6 +349,7 @@ MStatus Grower::initialize()
 	MFnNumericAttribute nFn;
 	MFnTypedAttribute	typedFn;	
 	MFnCompoundAttribute cFn;
+	MFnEnumAttribute	eFn;
 	MStatus				stat;
 
 	cacheSolution = nFn.create("cacheGrowth", "cg", MFnNumericData::kBoolean, false, &stat);
@@ -245,6 +371,11 @@ MStatus Grower::initialize()
 	cFn.addChild( inputNormals );
 	cFn.setHidden( true );
 
+	inputSampleData = typedFn.create( "sampleData", "sda", SampleData::id );
+	typedFn.setStorable( false );
+	typedFn.setWritable( true );
+	typedFn.setHidden( true );
+
 	inputPosition = nFn.createPoint( "inputPos", "ip" );
 	nFn.setStorable( false );
 	nFn.setWritable( true );
@@ -277,17 +408,63 @@ MStatus Grower::initialize()
 	nFn.setStorable( true );
 	nFn.setWritable( true );
 
+	algorithm = eFn.create( "algorithm", "alg", GA_NODE_CENTRIC, &stat );
+	if (!stat) return stat;
+	eFn.addField( "nodeCentric", GA_NODE_CENTRIC );
+	eFn.addField( "attractorCentric", GA_ATTRACTOR_CENTRIC );
+	eFn.setStorable( true );
+	eFn.setWritable( true );
+
+	maxNodes = nFn.create( "maxNodes", "mxn", MFnNumericData::kInt, 0, &stat );
+	if (!stat) return stat;
+	nFn.setMin( 0 );
+	nFn.setSoftMax( 100000 );
+	nFn.setStorable( true );
+	nFn.setWritable( true );
+
+	timeBudget = nFn.create( "timeBudget", "tbg", MFnNumericData::kFloat, 0.0f, &stat );
+	if (!stat) return stat;
+	nFn.setMin( 0.0f );
+	nFn.setSoftMax( 60.0f );
+	nFn.setStorable( true );
+	nFn.setWritable( true );
+
+	iterations = nFn.create( "iterations", "itr", MFnNumericData::kInt, 0, &stat );
+	if (!stat) return stat;
+	nFn.setMin( 0 );
+	nFn.setSoftMax( 500 );
+	nFn.setStorable( true );
+	nFn.setWritable( true );
+	nFn.setKeyable( true );
+
 	aoMeshData = typedFn.create( "output", "out", GrowerData::id );
-	typedFn.setWritable( false );
-	typedFn.setStorable(false);
+	// stored in the scene so that the network doesn't need to be regrown
+	// when the file is opened (it must be writable for Maya to set it back)
+	typedFn.setWritable( true );
+	typedFn.setStorable( true );
 	typedFn.setHidden( true );
 
+	statComputeTime = CreateStatAttribute( "statComputeTime", "sct", stat );
+	if (!stat) return stat;
+	statGrowTime = CreateStatAttribute( "statGrowTime", "sgt", stat );
+	if (!stat) return stat;
+	statIterations = CreateStatAttribute( "statIterations", "sitr", stat );
+	if (!stat) return stat;
+	statPeakFront = CreateStatAttribute( "statPeakFront", "spf", stat );
+	if (!stat) return stat;
+	statKnnQueries = CreateStatAttribute( "statKnnQueries", "skq", stat );
+	if (!stat) return stat;
+	statBytes = CreateStatAttribute( "statBytes", "sby", stat );
+	if (!stat) return stat;
+
 	// Add the attributes we have created to the node
 	//
 	stat = addAttribute(cacheSolution);
 	if (!stat) { stat.perror("addAttribute"); return stat; }
 	stat = addAttribute(inputSamples);
 	if (!stat) { stat.perror("addAttribute"); return stat;}
+	stat = addAttribute(inputSampleData);
+	if (!stat) { stat.perror("addAttribute"); return stat;}
 	stat = addAttribute( inputPosition );
 	if (!stat) { stat.perror("addAttribute"); return stat;}
 	stat = addAttribute( world2Local );
@@ -302,321 +479,165 @@ MStatus Grower::initialize()
 	if (!stat) { stat.perror("addAttribute"); return stat;}
 	stat = addAttribute( maxNeighbors );
 	if (!stat) { stat.perror("addAttribute"); return stat;}
+	stat = addAttribute( algorithm );
+	if (!stat) { stat.perror("addAttribute"); return stat;}
+	stat = addAttribute( maxNodes );
+	if (!stat) { stat.perror("addAttribute"); return stat;}
+	stat = addAttribute( timeBudget );
+	if (!stat) { stat.perror("addAttribute"); return stat;}
+	stat = addAttribute( iterations );
+	if (!stat) { stat.perror("addAttribute"); return stat;}
+	stat = addAttribute( statComputeTime );
+	if (!stat) { stat.perror("addAttribute"); return stat;}
+	stat = addAttribute( statGrowTime );
+	if (!stat) { stat.perror("addAttribute"); return stat;}
+	stat = addAttribute( statIterations );
+	if (!stat) { stat.perror("addAttribute"); return stat;}
+	stat = addAttribute( statPeakFront );
+	if (!stat) { stat.perror("addAttribute"); return stat;}
+	stat = addAttribute( statKnnQueries );
+	if (!stat) { stat.perror("addAttribute"); return stat;}
+	stat = addAttribute( statBytes );
+	if (!stat) { stat.perror("addAttribute"); return stat;}
 
 	attributeAffects( cacheSolution, aoMeshData );
 	attributeAffects( inputSamples, aoMeshData );
+	attributeAffects( inputSampleData, aoMeshData );
 	attributeAffects( inputPosition, aoMeshData );
 	attributeAffects( world2Local, aoMeshData );
 	attributeAffects( searchRadius, aoMeshData );
 	attributeAffects( killRadius, aoMeshData );
 	attributeAffects( growDist, aoMeshData );
 	attributeAffects( maxNeighbors, aoMeshData );
+	attributeAffects( algorithm, aoMeshData );
+	attributeAffects( maxNodes, aoMeshData );
+	attributeAffects( timeBudget, aoMeshData );
+	attributeAffects( iterations, aoMeshData );
 
 	return MS::kSuccess;
 
 }
 
-inline void insertUnique(std::vector<RenderLib::DataStructures::SampleIndex_t>& v, RenderLib::DataStructures::SampleIndex_t s) {
-	// we could use std::map instead of std::vector, but since the arrays are reused many times
-	// during running time, it's faster to do std::vector::resize(0) instead of std::set::clear() 
-	// to avoid memory reallocations.
-	std::vector<RenderLib::DataStructures::SampleIndex_t>::const_iterator it = v.begin();
-	for( ; it != v.end(); it++ ) {
-		if ( *it == s ) break;
-	}
-	if ( it == v.end() ) v.push_back(s);
-}
-
+//////////////////////////////////////////////////////////////////////////
+// MayaGrowthMonitor
+//
+//	Shows the growth progress on Maya's progress bar, and stops the growth
+//	when the user hits Esc.
 //////////////////////////////////////////////////////////////////////////
 
-void Grower::Grow( const MPointArray& points, 
-				   const MVectorArray& normals, 
-				   const MPoint& sourcePos, 
-				   const float searchRadius, 
-				   const float killRadius, 
-				   const int maxNeighbors, 
-				   const float nodeGrowDist, 
-				   bool useCachedSolution,
-				   GrowerData* inOutData) {
-
-	using namespace std;
-
-	std::vector< growerNode_t >& nodes = inOutData->nodes;
-	
-	KdTree knn;
-	if ( !knn.Init( points, normals ) ) {
-		return;
+class MayaGrowthMonitor : public GrowthMonitor {
+public:
+	MayaGrowthMonitor() {
+		computation.beginComputation( true, true, true );
+		computation.setProgressRange( 0, 100 );
 	}
-	
-	vector< RenderLib::DataStructures::SampleIndex_t > aliveNodes;
-
-	growerNode_t seed;
-	seed.pos = sourcePos;
-	RenderLib::DataStructures::SampleIndex_t* neighbors = (RenderLib::DataStructures::SampleIndex_t*)alloca( ( maxNeighbors + 1 ) * sizeof(RenderLib::DataStructures::SampleIndex_t) );
-
-	vector<bool> activeAttractors;
-	activeAttractors.resize(points.length());
-	vector<RenderLib::DataStructures::SampleIndex_t> closestNode;
-	closestNode.resize(points.length());
-	vector<float> distance;
-	distance.resize(points.length());
-
-	for( size_t i = 0; i < points.length(); i++ ) { 
-		activeAttractors[i] = true; 
-		closestNode[i] = UINT_MAX;
-		distance[i] = FLT_MAX;
+	~MayaGrowthMonitor() {
+		computation.endComputation();
 	}
 
-	nodes.push_back( seed );
-	aliveNodes.push_back( 0 );
-
-	const bool generateSolutionCache = !useCachedSolution;
-
-	if (generateSolutionCache)
-	{
-		inOutData->m_cachedAffectedPoints.resize(0);
-		inOutData->m_cachedClosestNode.resize(0);
-		inOutData->m_cachedBannedAliveNodes.resize(0);
-		inOutData->m_cachedActiveAttractors.resize(0);
+	virtual bool Continue( float progress ) {
+		computation.setProgress( (int)( progress * 100 ) );
+		return !computation.isInterruptRequested();
 	}
 
-	vector< RenderLib::DataStructures::SampleIndex_t > affectedPoints;
-	vector< RenderLib::DataStructures::SampleIndex_t > bannedAliveNodes;
-
-	int iterationCount = 0;
-
-	while( !aliveNodes.empty() ) {
-		vector< RenderLib::DataStructures::SampleIndex_t > newNodes;
-		{
-			affectedPoints.resize(0);
-
-			if (useCachedSolution && inOutData->m_cachedAffectedPoints.size() > iterationCount)
-			{
-				affectedPoints.resize(inOutData->m_cachedAffectedPoints[iterationCount].size());
-				if (affectedPoints.size() > 0)
-				{
-					memcpy(&affectedPoints[0], &inOutData->m_cachedAffectedPoints[iterationCount][0], inOutData->m_cachedAffectedPoints[iterationCount].size() * sizeof(RenderLib::DataStructures::SampleIndex_t));
-				}
-
-				closestNode.resize(inOutData->m_cachedClosestNode[iterationCount].size());
-				if (closestNode.size() > 0)
-				{
-					memcpy(&closestNode[0], &inOutData->m_cachedClosestNode[iterationCount][0], inOutData->m_cachedClosestNode[iterationCount].size() * sizeof(RenderLib::DataStructures::SampleIndex_t));
-				}
-
-				bannedAliveNodes.resize(inOutData->m_cachedBannedAliveNodes[iterationCount].size());
-				if (bannedAliveNodes.size() > 0)
-				{
-					memcpy(&bannedAliveNodes[0], &inOutData->m_cachedBannedAliveNodes[iterationCount][0], inOutData->m_cachedBannedAliveNodes[iterationCount].size() * sizeof(RenderLib::DataStructures::SampleIndex_t));
-				}
-				iterationCount++;
-			}
-			else
-			{
-				// find the closest attraction point to each alive node
-				for (size_t i = 0; i < aliveNodes.size(); i++) {
-					const RenderLib::DataStructures::SampleIndex_t aliveNode = aliveNodes[i];
-					size_t found = knn.NearestNeighbors(nodes[aliveNode].pos, searchRadius, maxNeighbors, neighbors);
-					assert((int)found <= maxNeighbors);
-#if _DEBUG
-					for (size_t j = 0; j < found; j++) {
-						const double d = points[neighbors[j]].distanceTo(nodes[aliveNode].pos);
-						assert(d <= searchRadius);
-					}
-#endif
+private:
+	MComputation computation;
+};
 
-					for (size_t j = 0; j < found; j++) {
-						RenderLib::DataStructures::SampleIndex_t neighbor = neighbors[j];
-
-						// TODO: since we're checking whether the node is active outside of the knn.NearestNeighbors query
-						// some (or many) of the returned neighbors may be invalid, and therefore we're wasting space
-						// in the neighbors array. It would be more efficient to store the validity of a node within the
-						// kdtree, to skip invalid nodes during the nearestNeighbors query, but this would "pollute" the
-						// kdtree class with irrelevant filtering knowledge (we want to keep the class generic for further reuse).
-						if (!activeAttractors[neighbor]) continue;
-
-						insertUnique(affectedPoints, neighbor);
-
-						if (closestNode[neighbor] != UINT_MAX) {
-							if (closestNode[neighbor] != aliveNode) {
-								float dist = (float)nodes[aliveNode].pos.distanceTo(points[neighbor]);
-								if (dist < distance[neighbor]) {
-									closestNode[neighbor] = aliveNode;
-									distance[neighbor] = dist;
-								}
-							}
-						}
-						else 
-						{
-							closestNode[neighbor] = aliveNode;
-							distance[neighbor] = (float)nodes[aliveNode].pos.distanceTo(points[neighbor]);
-						}
-					} // for found
-				} // for alive nodes
-
-				inOutData->m_cachedAffectedPoints.push_back(affectedPoints);
-				inOutData->m_cachedClosestNode.push_back(closestNode);
-				
-			} // else useCachedSolution
-			
-			// those nodes which are marked as closest to an attraction point
-			// are the candidates to spawn new nodes, and therefore are the
-			// only ones which remain active for the next iteration
-			aliveNodes.resize(0);
-			for( size_t i = 0; i < affectedPoints.size(); i++ ) {
-				RenderLib::DataStructures::SampleIndex_t node = closestNode[affectedPoints[i]];
-				insertUnique(aliveNodes, node);
-			}
+// The progress bar can only be driven from the main thread of an 
+// interactive session, and isn't worth showing on every frame played back
+static bool ShowGrowthProgress() {
+	return MGlobal::mayaState() == MGlobal::kInteractive && IsMainThread() && !MAnimControl::isPlaying();
+}
 
-			if (generateSolutionCache)
-			{
-				inOutData->m_cachedBannedAliveNodes.push_back(std::vector<RenderLib::DataStructures::SampleIndex_t>());
-			}
-			
-			// spawn new nodes	
-			for( size_t i = 0; i < aliveNodes.size(); i++ ) {
-
-				const RenderLib::DataStructures::SampleIndex_t& nodeIdx = aliveNodes[i];
-				growerNode_t& srcNode = nodes[ nodeIdx ];
-
-				MVector growDirection( 0, 0, 0 );
-				size_t nAttractors = 0;
-
-				for( size_t j = 0; j < affectedPoints.size(); j++ ) {
-					if ( closestNode[affectedPoints[j]] != nodeIdx ) continue;
-
-					nAttractors ++;
-					MVector dir = points[affectedPoints[j]] - srcNode.pos;
-					dir.normalize();
-					growDirection += dir;
-				}
-
-				assert( nAttractors > 0 );
-				growDirection.normalize();
-
-				growerNode_t newNode;
-				newNode.pos = srcNode.pos + nodeGrowDist * growDirection;
-
-				bool duplicated = false;
-				if (generateSolutionCache)
-				{ 
-					std::vector<RenderLib::DataStructures::SampleIndex_t>& cachedBannedAliveNodesEntry = inOutData->m_cachedBannedAliveNodes[inOutData->m_cachedBannedAliveNodes.size() - 1];
-					for (size_t j = 0; j < srcNode.children.size(); j++) {
-						if (nodes[srcNode.children[j]].pos.distanceTo(newNode.pos) <= 0.0001f) {
-							duplicated = true;
-							cachedBannedAliveNodesEntry.push_back(nodeIdx);
-							break;
-						}
-					}
-				}
-				else
-				{
-					for (size_t j = 0; j < bannedAliveNodes.size(); ++j)
-					{
-						if (bannedAliveNodes[j] == nodeIdx)
-						{
-							duplicated = true;
-							break;
-						}
-					}
-				}
-
-				if ( duplicated ) {
-					// erase active element, as it is stuck in a loop trying to produce the same children
-				
-					aliveNodes[ i ] = aliveNodes[ aliveNodes.size() - 1 ];
-					aliveNodes.resize( aliveNodes.size() - 1 );
-					i--;		
-				
-				} else {
-					newNode.parent = nodeIdx;
-					RenderLib::DataStructures::SampleIndex_t newNodeIdx = (RenderLib::DataStructures::SampleIndex_t)nodes.size();
-					srcNode.children.push_back( newNodeIdx );
-					nodes.push_back( newNode );
-					newNodes.push_back( newNodeIdx );
-				}
-			}
-			for( size_t i = 0; i < newNodes.size(); i++ ) { 
-				aliveNodes.push_back( newNodes[ i ] );
-			}
-		}
+//////////////////////////////////////////////////////////////////////////
+// Grower::Grow
+//
+//	Feeds the samples to the space colonization in the core library,
+//	carrying on the growth kept in inOutData up to the given iterations
+//	(only when they weren't grown already) and outputting those. Stepping
+//	through the iterations one evaluation at a time therefore only grows
+//	the new ones, the sample index keeps the attraction points killed so
+//	far between evaluations.
+//////////////////////////////////////////////////////////////////////////
 
-		// use the new spawned nodes to kill close attractor points
-		if (generateSolutionCache)
-		{
-			for (size_t i = 0; i < newNodes.size(); i++) {
-				size_t found = knn.NearestNeighbors(nodes[newNodes[i]].pos, killRadius, maxNeighbors, neighbors);
-				assert((int)found <= maxNeighbors);
-				for (size_t j = 0; j < found; j++) {
-					activeAttractors[neighbors[j]] = false;
-				}
-			}
+int Grower::Grow( const samplePoints_t& samples, 
+				  const MPoint& sourcePos, 
+				  const float searchRadius, 
+				  const float killRadius, 
+				  const int maxNeighbors, 
+				  const float nodeGrowDist, 
+				  const int algorithm,
+				  const int maxNodes,
+				  const float timeBudget,
+				  const int iterations,
+				  bool useCachedSolution,
+				  GrowerData* inOutData,
+				  growthStats_t* stats ) {
+
+	// the index the Sampler built is copied rather than rebuilt, and only
+	// when the samples moved. Otherwise the previous evaluation's is reused.
+	KdTree& knn = m_sampleIndex;
+	if ( m_sampleIndexHash != samples.positionsHash || knn.Size() != samples.Size() ) {
+		if ( samples.HasIndex() ) {
+			knn = samples.index;
+		} else {
+			knn.Init( samples.Size() > 0 ? &samples.positions[ 0 ] : NULL, samples.Size() );
 		}
-	
-	} // while alive
-
-	// reactivate all the samples, we're going to retrieve the normals from them
-	for( unsigned int i = 0; i < points.length(); i++ ) {
-		activeAttractors[ i ] = true;
+		m_sampleIndexHash = samples.positionsHash;
+		knn.ActivateAll();
+		m_killedGrowthHash = 0;
 	}
 
-	const MVector zero(0,0,0);
-	const double minCosAngle = cos( 3.14159265 / 4 ); // 45 degrees
-	size_t numNodes = nodes.size(); // size will change inside the loop
-	for( size_t i = 0; i < numNodes; i++ ) {
-		growerNode_t& node = nodes[ i ];
-		// set normals
-		size_t found = knn.NearestNeighbors( node.pos, killRadius, 1, neighbors );
-		if ( found == 1 ) {
-			node.surfaceNormal = normals[neighbors[0]];
-		} else if ( node.parent != INVALID_PARENT && !nodes[ node.parent ].surfaceNormal.isEquivalent( zero, 0.001f ) ) {
-			node.surfaceNormal = nodes[ node.parent ].surfaceNormal;
-		/*} else if ( node.children.size() > 0 ) {
-			MVector avgNormal;
-			for( size_t j = 0; j < node.children.size(); j++ ) {
-				avgNormal += nodes[ node.children[ j ] ].surfaceNormal;
-			}
-			node.surfaceNormal = avgNormal / (double)node.children.size();
-		} else {*/
-		} else {
-			node.surfaceNormal = MVector( 0, 1, 0 );
+	growthParams_t params;
+	params.sourcePos	= vec3_t( sourcePos.x, sourcePos.y, sourcePos.z );
+	params.searchRadius	= searchRadius;
+	params.killRadius	= killRadius;
+	params.nodeGrowDist	= nodeGrowDist;
+	params.maxNeighbors	= maxNeighbors;
+	params.algorithm	= algorithm;
+	params.maxNodes		= (size_t)std::max( maxNodes, 0 );
+	params.timeBudget	= timeBudget;
+	params.maxIterations	= (size_t)std::max( iterations, 0 );
+
+	growthState_t& state = inOutData->m_state;
+	growthResult_e result = state.result;
+	if ( state.Started() && ( state.Finished() || ( params.maxIterations > 0 && params.maxIterations <= state.NumIterations() ) ) ) {
+		// grown that far already, only the output changes
+		if ( stats != NULL ) {
+			*stats = growthStats_t();
+		}
+	} else {
+		// the replay doesn't kill any point
+		if ( !useCachedSolution && ( m_killedGrowthHash != inOutData->m_stateHash || m_killedIterations != state.NumIterations() ) ) {
+			RestoreKilledSamples( state, knn );
 		}
 
-		//
-		if ( node.parent != INVALID_PARENT ) {
-			growerNode_t& parent = nodes[ node.parent ];
-			MVector fromParent = node.pos - parent.pos;
-			const double fromParentLength = fromParent.length();
-			fromParent /= fromParentLength;
-			for( size_t j = 0; j < node.children.size(); j++ ) {
-				growerNode_t& child = nodes[ node.children[ j ] ];
-				MVector toChild = child.pos - node.pos;
-				const double toChildLength = toChild.length();
-				toChild /= toChildLength;
-				const double cosAngle = fromParent * toChild;
-				if ( cosAngle < minCosAngle ) { 
-
-					child.parent = node.parent;
-					parent.children.push_back( node.children[ j ] );
-					if ( node.children.size() > 1 ) {
-						node.children[ j ] = node.children.back();
-						node.children.resize( node.children.size() - 1 );
-						j--;
-					} else {
-						node.children.clear();
-						break;
-					}							
-				}
-			}
+		MayaTaskRunner runner;
+		MayaGrowthMonitor* monitor = ShowGrowthProgress() ? new MayaGrowthMonitor : NULL;
+		result = ContinueGrowth( samples, knn, params, useCachedSolution, inOutData->m_cache, state, stats, monitor, runner );
+		delete monitor;
+
+		if ( !useCachedSolution ) {
+			m_killedGrowthHash = inOutData->m_stateHash;
+			m_killedIterations = state.NumIterations();
 		}
 	}
+	if ( params.maxIterations > 0 && params.maxIterations < state.NumIterations() ) {
+		// stepped back to an iteration grown earlier
+		result = GR_ITERATION_LIMIT;
+	}
+	OutputNodes( state, params.maxIterations, inOutData->nodes );
 
 #if GROWER_DISPLAY_DEBUG_INFO
-	for (unsigned int i = 0; i < points.length(); i++) {
+	// as of the last iteration grown
+	for (unsigned int i = 0; i < samples.Size(); i++) {
+		const vec3_t pos = samples.Pos(i);
 		attractionPointVis_t p;
-		p.pos = points[i];
-		p.active = activeAttractors[i];
+		p.pos = MPoint( pos.x, pos.y, pos.z );
+		p.active = state.activeAttractors[i];
 		inOutData->samples.push_back( p );
 	}
 #endif
+	return result;
 }
@@ -16,21 +16,29 @@
 #include <vector>
 
 #include "common.h"
+#include "core/NearestNeighbors.h"
 
 class GrowerData;
-struct growerNode_t;
+struct growerNodes_t;
 struct attractionPointVis_t;
+struct samplePoints_t;
+struct growthStats_t;
 
 /////////////////////////////////////////////////////////////////////
 //
 // class Grower
 //
-//	Constructs the hierarchy data from the sampling points
+//	Constructs the hierarchy data from the sampling points. The growth
+//	is kept in the output GrowerData, so that stepping the iterations
+//	attribute forward (e.g. keyed along the timeline) only grows the new
+//	iterations, and stepping it back outputs the ones already grown.
 // 
 /////////////////////////////////////////////////////////////////////
 
 class Grower : public MPxNode {
 public:
+	Grower() : m_sampleIndexHash( 0 ), m_killedGrowthHash( 0 ), m_killedIterations( 0 ) {}
+
 	// overrides
 
 	virtual MStatus	compute( const MPlug& plug, MDataBlock& dataBlock );
@@ -48,6 +56,7 @@ public:
 	static	MObject		inputSamples;	// input vector array
 	static	MObject		inputPoints;	
 	static	MObject		inputNormals;
+	static	MObject		inputSampleData;	// SampleData, takes over the samples array when connected
 
 	static	MObject		inputPosition;	// where the growing starts, in world coordinates
 	static	MObject		world2Local;	// to transform inputPosition to local coordinates
@@ -55,9 +64,21 @@ public:
 	static	MObject		killRadius;
 	static	MObject		growDist;
 	static	MObject		maxNeighbors;
+	static	MObject		algorithm;		// growthAlgorithm_e
+	static	MObject		maxNodes;		// stops the growth once reached, 0 for no limit
+	static	MObject		timeBudget;		// seconds the growth can take, 0 for no limit
+	static	MObject		iterations;		// growth iterations output, 0 for the whole growth
 	static	MObject		aoMeshData;		// GrowerData
 	static	MObject		cacheSolution;	// toggle to cache solution, used to stick grower to moving surfaces
 
+	// counters of the last evaluation, read-only (see GrowerStats.h)
+	static	MObject		statComputeTime;
+	static	MObject		statGrowTime;		// space colonization
+	static	MObject		statIterations;
+	static	MObject		statPeakFront;		// largest number of alive nodes
+	static	MObject		statKnnQueries;
+	static	MObject		statBytes;			// held by the nodes, the growth log and the kd-tree
+
 	// The typeid is a unique 32bit identifier that describes this node.
 	// It is used to save and retrieve nodes of this type from the binary
 	// file format.  If it is not unique, it will cause file IO problems.
@@ -66,15 +87,30 @@ public:
 	static const MString	typeName;
 
 private: 
-	void Grow( const MPointArray& points, 
-			   const MVectorArray& normals, 
-			   const MPoint& sourcePos, 
-			   const float searchRadius, 
-			   const float killRadius, 
-			   const int maxNeighbors, 
-			   const float nodeGrowDist, 
-			   bool useCachedSolution,
-			   GrowerData* inOutData );
+	// returns the growthResult_e
+	int Grow( const samplePoints_t& samples, 
+			  const MPoint& sourcePos, 
+			  const float searchRadius, 
+			  const float killRadius, 
+			  const int maxNeighbors, 
+			  const float nodeGrowDist, 
+			  const int algorithm,
+			  const int maxNodes,
+			  const float timeBudget,
+			  const int iterations,
+			  bool useCachedSolution,
+			  GrowerData* inOutData,
+			  growthStats_t* stats );
+
+	// kd-tree over the samples, which Grow deactivates points from. Kept
+	// across evaluations and only replaced when the sample positions change.
+	// The points deactivated are the ones killed by the growth started from
+	// m_killedGrowthHash, as of m_killedIterations, which are the same for
+	// any growth data holding that very same growth.
+	KdTree	m_sampleIndex;
+	MUint64	m_sampleIndexHash;
+	MUint64	m_killedGrowthHash;		// 0 for none
+	size_t	m_killedIterations;
 };
 
 #endif
@@ -6,7 +6,9 @@
 */
 #include "GrowerShape.h"
 #include "GrowerData.h"
-#include "NearestNeighbors.h"
+#include "MayaTaskRunner.h"
+#include "GrowerStats.h"
+#include "core/Hash.h"
 
 #include <maya/MPlug.h>
 #include <maya/MDataBlock.h>
@@ -22,10 +24,12 @@
 #include <maya/MGlobal.h>
 #include <maya/MFnMeshData.h>
 #include <maya/MRampAttribute.h>
+#include <maya/MFloatPointArray.h>
+#include <maya/MFloatArray.h>
+#include <maya/MPlugArray.h>
+#include <maya/MViewport2Renderer.h>
 #include <iostream>
 
-#include <stack>
-
 //////////////////////////////////////////////////////////////////////
 //
 // Error checking
@@ -55,9 +59,14 @@ const MString	GrowerShape::typeName( "GrowerShape" );
 // Attributes
 MObject		GrowerShape::tubeSections;
 MObject		GrowerShape::thicknessScale;
+MObject		GrowerShape::displayDensity;
 MObject		GrowerShape::thickness;
 MObject		GrowerShape::inputData;
 MObject		GrowerShape::outMesh;
+MObject		GrowerShape::statComputeTime;
+MObject		GrowerShape::statThicknessTime;
+MObject		GrowerShape::statMeshTime;
+MObject		GrowerShape::statBytes;
 
 /////////////////////////////////////////////////////////////////////////
 // GrowerShape::geometryData (override)
@@ -177,300 +186,104 @@ MStatus GrowerShape::compute( const MPlug& plug, MDataBlock& data )
 			return MS::kFailure;
 		}
 
-		if ( aoMeshData->nodes.size() == 0 ) {
+		StatTimer computeTimer( "compute", thisMObject() );
+		if ( aoMeshData->nodes.Size() == 0 ) {
 			// nothing to mesh
+			SetStat( data, statComputeTime, computeTimer.Stop() );
 			data.setClean(plug);
 			return MS::kSuccess;
 		}
 
-		MFnMeshData meshData;
-		MObject fnMeshObj = meshData.create();
+		int tubeSections = data.inputValue( GrowerShape::tubeSections ).asInt();
+		float* thicknessArray = (float*)calloc( aoMeshData->nodes.Size(), sizeof(float) );
+		float thicknessScale = data.inputValue(GrowerShape::thicknessScale).asFloat();
+		UpdateThicknessLut();
+		MayaTaskRunner runner;
+		StatTimer thicknessTimer( "calculateThickness", thisMObject() );
+		CalculateThickness(aoMeshData->nodes, &m_thicknessLut[ 0 ], thicknessScale, thicknessArray, runner);
+		SetStat( data, statThicknessTime, thicknessTimer.Stop() );
+
+		// while the connectivity doesn't change (e.g. scrubbing the thickness
+		// sliders) only the vertices of the previous mesh are rewritten
+		StatTimer meshTimer( "createMesh", thisMObject() );
+		MObject fnMeshObj = fnMeshHandle.asMesh();
+		bool sameTopology = !fnMeshObj.isNull() && 
+							m_topology.hash == HashTopology( aoMeshData->nodes, tubeSections );
 		MFnMesh fnMesh;
-		{
-			MPointArray vertexArray;
-			MIntArray polygonCounts, indices;
-			int tubeSections = data.inputValue( GrowerShape::tubeSections ).asInt();
-			float* thicknessArray = (float*)calloc( aoMeshData->nodes.size(), sizeof(float) );
-			float thicknessScale = data.inputValue(GrowerShape::thicknessScale).asFloat();
-			size_t activeNodes = CalculateThickness(aoMeshData->nodes, thicknessScale, thicknessArray);
-			CreateMesh( aoMeshData, activeNodes, tubeSections, thicknessArray, vertexArray, indices, polygonCounts );
-			free( thicknessArray );
-			const int numQuads = indices.length() / 4;
-			fnMesh.create( vertexArray.length(), numQuads, vertexArray, polygonCounts, indices, fnMeshObj );
+		if ( sameTopology ) {
+			sameTopology = fnMesh.setObject( fnMeshObj ) == MS::kSuccess && 
+						   fnMesh.numVertices() == (int)m_topology.numVertices &&
+						   fnMesh.numPolygons() == (int)m_topology.numQuads;
+		}
+		if ( !sameTopology ) {
+			BuildTopology( aoMeshData->nodes, tubeSections, m_topology );
+		}
+
+		std::vector< float > vertices;
+		std::vector< int > indices;
+		CreateMesh( aoMeshData->nodes, m_topology, thicknessArray, vertices, sameTopology ? NULL : &indices, runner );
+		free( thicknessArray );
+		SetStat( data, statMeshTime, meshTimer.Stop() );
+		SetStat( data, statBytes, (double)( aoMeshData->nodes.Size() * sizeof( float ) +
+											vertices.capacity() * sizeof( float ) +
+											indices.capacity() * sizeof( int ) +
+											m_topology.vertexOffsets.capacity() * sizeof( int ) +
+											m_topology.quadOffsets.capacity() * sizeof( unsigned int ) ) );
+
+		const unsigned int numVertices = m_topology.numVertices;
+		const unsigned int numQuads = m_topology.numQuads;
+		MFloatPointArray vertexArray( vertices.empty() ? NULL : (const float (*)[4])&vertices[ 0 ], numVertices );
+		if ( sameTopology ) {
+			fnMesh.setPoints( vertexArray );
+		} else {
+			MFnMeshData meshData;
+			fnMeshObj = meshData.create();
+			MIntArray indexArray( indices.empty() ? NULL : &indices[ 0 ], (unsigned int)indices.size() );
+			MIntArray polygonCounts( numQuads, 4 );
+			fnMesh.create( numVertices, numQuads, vertexArray, polygonCounts, indexArray, fnMeshObj );
 		}
 
 		fnMeshHandle.set( fnMeshObj );
+		SetStat( data, statComputeTime, computeTimer.Stop() );
 		data.setClean(plug);
 		return MS::kSuccess;
 	}
 	return MS::kUnknownParameter;
 }
 
-void GrowerShape::CreateMesh( const GrowerData* data, const size_t activeNodes, const int tubeSections, const float* thickness, MPointArray& vertices, MIntArray& indices, MIntArray& polygonCounts ) const {
-
-	if ( activeNodes == 0 || tubeSections == 0 ) {
-		return;
-	}
-
-	enum trimmStatus_e {
-		TS_UNVISITED	= 0,
-		TS_TRIMMED		= 1,
-		TS_ACTIVE		= 2
-	};
-	short* trimmedNodes = ( short* )calloc( data->nodes.size(), sizeof( short ) );
-	int* vertexOffsets = ( int* )malloc( data->nodes.size() * sizeof( int ) );
-
-	size_t remaining = 0;
-	for( size_t i = 0; i < data->nodes.size(); i++ ) {
-		bool trimmed = data->nodes[ i ].trimmed;
-		if ( !trimmed ) {
-			size_t parent = data->nodes[ i ].parent;
-			if ( parent != INVALID_PARENT ) {
-				// by construction of the array, parents are always
-				// processed before a child is, so we can rely on
-				// the parent node's trimmed value to have been set
-				trimmed = ( trimmedNodes[ parent ] != TS_ACTIVE ) ;
-				assert( trimmedNodes[ parent ] != TS_UNVISITED );
-			}			
-		}
-		trimmedNodes[ i ] = trimmed ? (short)TS_TRIMMED : (short)TS_ACTIVE;
-		if ( !trimmed ) {
-			remaining += std::max( (size_t)1, data->nodes[ i ].children.size() );
-		}
-	}
-	//assert( remaining == activeNodes );
-
-	// create vertices
-	unsigned int vOffset = 0;
-	vertices.setLength( tubeSections * (unsigned int)remaining );
-	for( size_t i = 0; i < data->nodes.size(); i++ ) {
-		if ( trimmedNodes[ i ] == TS_TRIMMED ) {
-			vertexOffsets[ i ] = -1;
-			continue;
-		}
-		const growerNode_t& node = data->nodes[ i ];
-		MVector axis;
-		if ( node.children.size() > 0 ) {
-			size_t thickerChild = 0;
-			float largestThickness = 0;
-			for( size_t j = 0; j < node.children.size(); j++ ) {
-				const growerNode_t& child = data->nodes[ node.children[ j ] ];
-				if( thickness[ node.children[ j ] ] > largestThickness ) {
-					largestThickness = thickness[ node.children[ j ] ];
-					thickerChild = j;
-
-					axis = child.pos - node.pos;
-				}
-			}
-			axis.normalize();
-		} else if( node.parent != INVALID_PARENT ) {
-			axis = node.pos - data->nodes[ node.parent ].pos;
-			axis.normalize();
-		} else {
-			// isolated node?
-			axis = MVector( 1, 0, 0 );
-		}
-
-		MMatrix t;
-		MVector ox, oy, oz;
-		oz = axis;
-		oz.normalize();
-		ox = oz ^ node.surfaceNormal;
-		oy = oz ^ ox;
-
-		const float thick = thickness [ i ];
-
-		t[ 0 ][ 0 ] = ox.x;	t[ 0 ][ 1 ] = ox.y;	t[ 0 ][ 2 ] = ox.z;	t[ 0 ][ 3 ] = 0; 
-		t[ 1 ][ 0 ] = oy.x;	t[ 1 ][ 1 ] = oy.y;	t[ 1 ][ 2 ] = oy.z;	t[ 1 ][ 3 ] = 0; 
-		t[ 2 ][ 0 ] = oz.x;	t[ 2 ][ 1 ] = oz.y;	t[ 2 ][ 2 ] = oz.z;	t[ 2 ][ 3 ] = 0; 
-		t[ 3 ][ 0 ] = node.pos.x + node.surfaceNormal.x * thick; 
-		t[ 3 ][ 1 ] = node.pos.y + node.surfaceNormal.y * thick; 
-		t[ 3 ][ 2 ] = node.pos.z + node.surfaceNormal.z * thick; 
-		t[ 3 ][ 3 ] = 1;
-		float radStep = 2.0f * 3.141592f / tubeSections;
-		for( unsigned int k = 0; k < std::max( (unsigned int)1, (unsigned int)node.children.size() ); k++ ) {
-			float angle = 0;
-			for( unsigned int j = 0; j < (unsigned int)tubeSections; j++ ) {
-				MPoint p( thick * cos( angle ), thick * sin( angle ), 0 );
-				vertices[ vOffset + tubeSections * k + j ] = p * t;
-				angle += radStep;
-			}
-		}
-
-		vertexOffsets[ i ] = vOffset;
-		vOffset += tubeSections * std::max( (unsigned int)1, (unsigned int)node.children.size() );
+MStatus GrowerShape::setDependentsDirty( const MPlug& plug, MPlugArray& plugArray ) {
+	if ( plug == inputData ) {
+		m_geometryVersion++;
+		MHWRender::MRenderer::setGeometryDrawDirty( thisMObject() );
+	} else if ( plug == displayDensity ) {
+		MHWRender::MRenderer::setGeometryDrawDirty( thisMObject(), false );
 	}
-
-	assert( vOffset == remaining * tubeSections );
-	free( trimmedNodes );
-
-	// create triangles
-	const unsigned int numTris = 2 * tubeSections * ((unsigned int)activeNodes - 1 ); // do not count the root node (as we generate triangles towards it, but not from it)
-	indices.setLength( 2 * numTris );
-	unsigned int offset = 0;
-	for( int i = 1; i < (int)data->nodes.size(); i++ ) {
-		if ( vertexOffsets[ i ] == -1 ) {
-			continue;
-		}
-
-		const growerNode_t& node = data->nodes[ i ];
-		assert( node.parent != INVALID_PARENT );
-		const growerNode_t& parent = data->nodes[ node.parent ];
-		unsigned int childIdx = 0;
-		for( ; ; childIdx++ ) {
-			if( parent.children[ childIdx ] == i ) {
-				break;
-			}
-		}
-		const int vertexOffsetA = vertexOffsets[ node.parent ] + tubeSections * childIdx;
-		const int vertexOffsetB = vertexOffsets[ i ];
-		for( int j = 0; j < tubeSections; j++ ) {
-			assert( vertexOffsetA + j < tubeSections * (int)remaining );
-			assert( vertexOffsetA + j + ( j + 1 ) % tubeSections < tubeSections * (int)remaining );
-
-			indices[ offset++ ] = vertexOffsetA + j;
-			indices[ offset++ ] = vertexOffsetA + ( j + 1 ) % tubeSections;
-			indices[offset++] = vertexOffsetB + (j + 1) % tubeSections;
-			indices[offset++] = vertexOffsetB + j;
-		}
-	}
-	assert( offset == 2 * numTris );
-	// 
-	polygonCounts.setLength( (int)offset / 4 );
-	for( unsigned int i = 0; i < offset / 4; i++ ) {
-		polygonCounts[ i ] = 4;		
-	}
-
-	
-	free( vertexOffsets );
-
+	return MPxSurfaceShape::setDependentsDirty( plug, plugArray );
 }
 
-size_t GrowerShape::CalculateThickness(std::vector< growerNode_t >& nodes, float thicknessScale, float* thicknessArray) {
-	
-	// calculate branch thickness. This is a recursive process where 
-	// thickness( node_i ) = function( thickness( child0(node_i) ), thickness( child0(node_i) ), ... )
-	// but let's not perform recursive function calls as we can easily blow up the stack
-
-	size_t activeNodes = 0;
-	const float baseThickness = 1.f;
-
+void GrowerShape::UpdateThicknessLut() {
 	MRampAttribute thicknessRemapping(thisMObject(), thickness);
-	
-	std::vector< size_t > terminators;
-	std::stack< size_t > recursion;
-	recursion.push( 0 );
-	while( !recursion.empty() ) {
-		size_t node = recursion.top();
-
-		bool calculated = false;
 
-		if ( nodes[ node ].children.size() == 0 || 
-			( nodes[ node].children.size() == 1 && nodes[ nodes[ node ].children[ 0 ] ].trimmed ) ) {
-			terminators.push_back( node );
-		}
-
-		if ( nodes[ node ].children.size() == 0 || nodes[ node ].trimmed ) {			
-			calculated = true;			
-		} else {
-			size_t childrenReady = 0;
-			for( size_t i = 0; i < nodes[ node ].children.size(); i++ ) {
-				if ( thicknessArray[ nodes[ node ].children[ i ] ] >= baseThickness ) {
-					childrenReady++;
-				} else {
-					break;
-				}
-			}
-			calculated = ( childrenReady == nodes[ node ].children.size() );
-		}
-
-		if ( calculated ) {
-			recursion.pop();
-			
-			if ( !nodes[ node ].trimmed ) {
-				activeNodes++;
-			}
-
-			if ( nodes[ node ].children.size() == 0 || nodes[ node ].trimmed ) {
-				thicknessArray[ node ] = baseThickness;
-			} else {
-				float sqRadius = 0;
-				for( size_t i = 0; i < nodes[ node ].children.size(); i++ ) {
-					const float t = thicknessArray[ nodes[ node ].children[ i ] ];
-					sqRadius += t * t;
-				}
-				thicknessArray[ node ] = sqrtf( sqRadius );
-			}
-
-		} else {
-			for( size_t i = 0; i < nodes[ node ].children.size(); i++ ) {
-				const size_t child = nodes[ node ].children[ i ];
-				if ( thicknessArray[ child ] < baseThickness ) {
-					recursion.push( child );
-				}
-			}
-		}
+	// the table only needs to be baked again if the ramp keys changed
+	MIntArray indices, interpolations;
+	MFloatArray positions, values;
+	thicknessRemapping.getEntries( indices, positions, values, interpolations );
+	MUint64 hash = HASH_SEED;
+	for( unsigned int i = 0; i < indices.length(); i++ ) {
+		hash = HashValue( hash, indices[ i ] );
+		hash = HashValue( hash, positions[ i ] );
+		hash = HashValue( hash, values[ i ] );
+		hash = HashValue( hash, interpolations[ i ] );
 	}
-
-	// now force the terminator nodes to have a thickness of 0 so they end in a spike
-	for( size_t i = 0; i < terminators.size(); i++ ) {
-		thicknessArray[ terminators[ i ] ] = 0.0001f;
+	if ( !m_thicknessLut.empty() && hash == m_thicknessLutHash ) {
+		return;
 	}
 
-	// track down the bifurcations, for each single-child node path, interpolate
-	// the nodes thickness to smooth out appearance
-	
-	for( size_t i = 0; i < nodes.size(); i++ ) {
-		growerNode_t& node = nodes[ i ];
-		if ( node.children.size() > 0 ) {
-			for( size_t j = 0; j < node.children.size(); j++ ) {
-				size_t start = i;
-				size_t finish = i;
-				size_t pathLength = 0;
-				while( nodes[ finish ].children.size() == 1 ) {
-					finish = nodes[ finish ].children[ 0 ];
-					pathLength++;
-				}
-				if ( pathLength > 1 ) {
-					const float startThickness = thicknessArray[ start ];
-					const float finishThickness = thicknessArray[ finish ];
-					const float delta = ( finishThickness - startThickness ) / pathLength;
-					if ( delta < 0.001f ) {
-						// not worth it
-						break;
-					}
-					size_t k = 0;
-					finish = nodes[ finish ].parent; // avoid reaching the node which numChildren != 1 (could be 0!)
-					while( start != finish ) {
-						thicknessArray[ start ] += delta * k;
-						k++;
-						start = nodes[ k ].children[ 0 ];
-					}
-				}
-			}
-		}
-	}
-	
-	float maxThickness = 0;
-	float minThickness = FLT_MAX;
-	for (size_t i = 0; i < nodes.size(); i++) {
-		const float thickness = thicknessArray[i];
-		maxThickness = std::max(maxThickness, thickness);
-		minThickness = std::min(minThickness, thickness);
-	}
-	minThickness = std::min(minThickness, maxThickness);
-	maxThickness = std::max(maxThickness, minThickness + 1e-8f);
-
-	for (size_t i = 0; i < nodes.size(); i++) {
-		float normalizedThickness = (thicknessArray[i] - minThickness) / (1e-8f + maxThickness - minThickness);
-		float inputThickness = normalizedThickness * thicknessScale;
-		float remappedThickness;
-		// the 1.0f - X is because it's more intuitive to see the curve from thick to thin, instead of the natural order thin (0) to thick (1)
-		thicknessRemapping.getValueAtPosition(std::max(0.f, std::min(1.f, 1.0f - inputThickness)), remappedThickness);
-		thicknessArray[i] = remappedThickness;
+	m_thicknessLut.resize( THICKNESS_LUT_SIZE + 1 );
+	for( int i = 0; i <= THICKNESS_LUT_SIZE; i++ ) {
+		thicknessRemapping.getValueAtPosition( (float)i / THICKNESS_LUT_SIZE, m_thicknessLut[ i ] );
 	}
-
-	return activeNodes;
+	m_thicknessLutHash = hash;
 }
 
 void* GrowerShape::creator()
@@ -521,6 +334,13 @@ MStatus GrowerShape::initialize()
 
 	thickness = MRampAttribute::createCurveRamp("thickness", "th");
 
+	displayDensity = nFn.create("displayDensity", "dd", MFnNumericData::kFloat, 1.0f);
+	nFn.setWritable(true);
+	nFn.setReadable(true);
+	nFn.setStorable(true);
+	nFn.setMin(0.f);
+	nFn.setMax(1.f);
+
 	inputData = typedFn.create( "input", "in", GrowerData::id );
 	typedFn.setWritable( true );
 	typedFn.setReadable( true );
@@ -531,6 +351,15 @@ MStatus GrowerShape::initialize()
 	typedFn.setStorable(false);
 	typedFn.setWritable(false);
 
+	statComputeTime = CreateStatAttribute( "statComputeTime", "sct", stat );
+	if ( !stat ) return stat;
+	statThicknessTime = CreateStatAttribute( "statThicknessTime", "stt", stat );
+	if ( !stat ) return stat;
+	statMeshTime = CreateStatAttribute( "statMeshTime", "smt", stat );
+	if ( !stat ) return stat;
+	statBytes = CreateStatAttribute( "statBytes", "sby", stat );
+	if ( !stat ) return stat;
+
 	// Add the attributes we have created to the node
 	//
 	stat = addAttribute( tubeSections );
@@ -539,10 +368,20 @@ MStatus GrowerShape::initialize()
 	if (!stat) { stat.perror("addAttribute"); return stat; }
 	stat = addAttribute( thickness );
 	if (!stat) { stat.perror("addAttribute"); return stat;}
+	stat = addAttribute( displayDensity );
+	if (!stat) { stat.perror("addAttribute"); return stat;}
 	stat = addAttribute( inputData );
 	if (!stat) { stat.perror("addAttribute"); return stat;}
 	stat = addAttribute( outMesh );
 	if (!stat) { stat.perror("addAttribute"); return stat;}
+	stat = addAttribute( statComputeTime );
+	if (!stat) { stat.perror("addAttribute"); return stat;}
+	stat = addAttribute( statThicknessTime );
+	if (!stat) { stat.perror("addAttribute"); return stat;}
+	stat = addAttribute( statMeshTime );
+	if (!stat) { stat.perror("addAttribute"); return stat;}
+	stat = addAttribute( statBytes );
+	if (!stat) { stat.perror("addAttribute"); return stat;}
 
 	attributeAffects( tubeSections, outMesh );
 	attributeAffects( thicknessScale, outMesh );
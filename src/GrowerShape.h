@@ -12,10 +12,12 @@
 #include <maya/MFnMesh.h>
 #include <maya/MPointArray.h>
 #include <maya/MPxSurfaceShape.h>
+#include <maya/MTypes.h>
+#include "core/Thickness.h"
+#include "core/TubeMesh.h"
 #include <vector>
 
 class GrowerData;
-struct growerNode_t;
 struct attractionPointVis_t;
 
 /////////////////////////////////////////////////////////////////////
@@ -31,12 +33,13 @@ struct attractionPointVis_t;
 class GrowerShape : public MPxSurfaceShape
 {
 public:
-						GrowerShape() {}
+						GrowerShape() : m_thicknessLutHash( 0 ), m_geometryVersion( 0 ) {}
 	virtual				~GrowerShape() {}
 	
 	// overrides
 
 	virtual MStatus			compute( const MPlug& plug, MDataBlock& data );
+	virtual MStatus			setDependentsDirty( const MPlug& plug, MPlugArray& plugArray );
 
 	virtual bool			isBounded() const;
 	virtual MBoundingBox	boundingBox() const;
@@ -49,6 +52,9 @@ public:
 	MObject					MeshDataRef();
 	GrowerData*				MeshGeometry();
 	const GrowerData*		MeshGeometry() const;
+	// bumped every time the input data changes, tells the viewport 
+	// overrides when to fetch it again
+	unsigned int			GeometryVersion() const { return m_geometryVersion; }
 
 	static  void*			creator();
 	static  MStatus			initialize();
@@ -62,9 +68,16 @@ public:
 	static	MObject		tubeSections;
 	static  MObject		thicknessScale;
 	static	MObject		thickness;
+	static	MObject		displayDensity;	// fraction of the branches drawn in the viewport, thinnest ones are culled first
 	static	MObject		inputData;		// GrowerData
 	static	MObject		outMesh;		// output MFnMesh
 
+	// counters of the last evaluation, read-only (see GrowerStats.h)
+	static	MObject		statComputeTime;
+	static	MObject		statThicknessTime;
+	static	MObject		statMeshTime;	// topology and vertices
+	static	MObject		statBytes;		// allocated while meshing, along with the topology kept
+
 	// The typeid is a unique 32bit identifier that describes this node.
 	// It is used to save and retrieve nodes of this type from the binary
 	// file format.  If it is not unique, it will cause file IO problems.
@@ -73,8 +86,12 @@ public:
 	static const MString	typeName;
 
 private:
-	void CreateMesh( const GrowerData* data, const size_t activeNodes, const int tubeSections, const float* thickness, MPointArray& vertices, MIntArray& indices, MIntArray& polygonCounts ) const;
-	size_t CalculateThickness(std::vector< growerNode_t >& nodes, float thicknessScale, float* thicknessArray);
+	void UpdateThicknessLut();
+
+	growerMeshTopology_t	m_topology;			// of the last mesh created
+	std::vector< float >	m_thicknessLut;		// thickness ramp baked at THICKNESS_LUT_SIZE + 1 positions
+	MUint64					m_thicknessLutHash;	// of the ramp entries the table was baked from
+	unsigned int			m_geometryVersion;
 };
 
 #endif // MesherNode_h__
@@ -20,6 +20,7 @@
 #include <maya/MSelectionList.h>
 #include <maya/MDagPath.h>
 #include <maya/MFnSingleIndexedComponent.h>
+#include <maya/MPlug.h>
 
 #include <iostream>
 
@@ -306,33 +307,43 @@ void GrowerShapeUI::DrawWireframe( const MDrawRequest & request, M3dView & view
 	glEnd();
 #endif
 
-	glColor3f( 1, 0, 0 );	
-	for( unsigned int i = 0; i < geom->nodes.size(); i++ ) {
-		const growerNode_t& node = geom->nodes[ i ];
-		for( size_t j = 0; j < node.children.size(); j++ ) {
-			const growerNode_t& child = geom->nodes[ node.children[ j ] ];
+	// the segments are drawn straight out of the node arrays (GL 1.1 
+	// vertex arrays, also available under software GL), the index pairs 
+	// are only rebuilt when the hierarchy, the display density or the 
+	// level of detail change.
+	const growerNodes_t& nodes = geom->nodes;
+	if ( !nodes.segments.empty() ) {
+		GrowerShape* shape = (GrowerShape*)surfaceShape();
+		const float density = MPlug( shape->thisMObject(), GrowerShape::displayDensity ).asFloat();
+
+		MMatrix modelView, projection;
+		GLint viewport[ 4 ];
+		glGetDoublev( GL_MODELVIEW_MATRIX, &modelView.matrix[ 0 ][ 0 ] );
+		glGetDoublev( GL_PROJECTION_MATRIX, &projection.matrix[ 0 ][ 0 ] );
+		glGetIntegerv( GL_VIEWPORT, viewport );
+		const float tolerance = LOD_PIXEL_ERROR * GrowerWireframeLOD::PixelSize( geom->bounds, modelView, projection, viewport[ 3 ] );
+
+		m_lod.Update( nodes, shape->GeometryVersion() );
+		m_lod.Select( tolerance, density );
+		const std::vector< unsigned int >& segments = m_lod.Segments();
+
+		glPushClientAttrib( GL_CLIENT_VERTEX_ARRAY_BIT );
+		glEnableClientState( GL_VERTEX_ARRAY );
+		glVertexPointer( 3, GL_FLOAT, 0, &nodes.pos[ 0 ] );
+
+		glLineWidth( 3.0f );
+		glColor3f( 1, 0, 0 );
+		if ( !segments.empty() ) {
+			glDrawElements( GL_LINES, (GLsizei)segments.size(), GL_UNSIGNED_INT, &segments[ 0 ] );
+		}
 
 #if GROWER_DISPLAY_DEBUG_INFO
-			glLineWidth( 3.0f );
-			glColor3f( 1, 0, 0 );
-			glBegin( GL_LINES );
-			glVertex3f( (float)node.pos.x, (float)node.pos.y, (float)node.pos.z );
-			glVertex3f( (float)child.pos.x, (float)child.pos.y, (float)child.pos.z );
-			glEnd();
-
-			glPointSize( 3.0f );
-			glBegin( GL_POINTS );
-			glColor3f( 1, 1, 1 );
-			glVertex3f( (float)child.pos.x, (float)child.pos.y, (float)child.pos.z );
-			glEnd();
-#else 
-			glLineWidth( 3.0f );
-			glBegin( GL_LINES );
-			glVertex3f( (float)node.pos.x, (float)node.pos.y, (float)node.pos.z );
-			glVertex3f( (float)child.pos.x, (float)child.pos.y, (float)child.pos.z );
-			glEnd();
+		glPointSize( 3.0f );
+		glColor3f( 1, 1, 1 );
+		glDrawElements( GL_POINTS, (GLsizei)nodes.children.size(), GL_UNSIGNED_INT, &nodes.children[ 0 ] );
 #endif
-		}
+
+		glPopClientAttrib();
 	}
 
 #if GROWER_DISPLAY_DEBUG_INFO
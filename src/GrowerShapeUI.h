@@ -10,6 +10,7 @@
 
 #include <maya/MPxSurfaceShapeUI.h> 
 #include "GrowerData.h" 
+#include "GrowerWireframeLOD.h"
 #include "common.h"
 
 /////////////////////////////////////////////////////////////////////
@@ -75,6 +76,7 @@ private:
 		kLastToken
 	};
 
+	mutable GrowerWireframeLOD	m_lod;
 };
 
 #endif // GrowerUI_h__
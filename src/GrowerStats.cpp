@@ -0,0 +1,255 @@
+/* 
+	================================================================================
+	Copyright (c) 2012, Jose Esteve. http://www.joesfer.com
+	This software is released under the LGPL-3.0 license: http://www.opensource.org/licenses/lgpl-3.0.html	
+	================================================================================
+*/
+
+#include "GrowerStats.h"
+#include "SamplerNode.h"
+#include "GrowerNode.h"
+#include "TrimmerNode.h"
+#include "GrowerShape.h"
+#include "core/Profiler.h"
+
+#include <maya/MArgDatabase.h>
+#include <maya/MSelectionList.h>
+#include <maya/MDagPath.h>
+#include <maya/MDataHandle.h>
+#include <maya/MFnAttribute.h>
+#include <maya/MFnDependencyNode.h>
+#include <maya/MFnNumericAttribute.h>
+#include <maya/MItDependencyNodes.h>
+#include <maya/MPlug.h>
+#include <maya/MSpinLock.h>
+
+#include <stdio.h>
+#include <map>
+#include <string>
+#include <vector>
+
+//////////////////////////////////////////////////////////////////////////
+// Trace
+//
+//	Ring buffer of the last MAX_TRACE_EVENTS stages timed by any node.
+//////////////////////////////////////////////////////////////////////////
+
+#define MAX_TRACE_EVENTS	65536
+
+struct traceEvent_t {
+	const char*	stage;
+	std::string	nodeType;
+	std::string	node;
+	double		start;		// seconds
+	double		duration;
+};
+
+static std::vector< traceEvent_t >	traceEvents;
+static size_t						traceOldest = 0;	// once the buffer wraps around
+static MSpinLock					traceLock;
+
+static void RecordTraceEvent( const traceEvent_t& e ) {
+	traceLock.lock();
+	if ( traceEvents.size() < MAX_TRACE_EVENTS ) {
+		traceEvents.push_back( e );
+	} else {
+		traceEvents[ traceOldest ] = e;
+		traceOldest = ( traceOldest + 1 ) % MAX_TRACE_EVENTS;
+	}
+	traceLock.unlock();
+}
+
+static void ClearTrace() {
+	traceLock.lock();
+	traceEvents.clear();
+	traceOldest = 0;
+	traceLock.unlock();
+}
+
+static MStatus WriteTrace( const MString& path ) {
+	// copy the events out, oldest first, so that the nodes don't wait on the file
+	std::vector< traceEvent_t > events;
+	traceLock.lock();
+	events.reserve( traceEvents.size() );
+	for( size_t i = 0; i < traceEvents.size(); i++ ) {
+		events.push_back( traceEvents[ ( traceOldest + i ) % traceEvents.size() ] );
+	}
+	traceLock.unlock();
+
+	FILE* f = fopen( path.asChar(), "w" );
+	if ( f == NULL ) {
+		return MS::kFailure;
+	}
+
+	// one timeline row per node, timestamps in microseconds from the oldest event
+	std::map< std::string, int > rows;
+	const double origin = events.empty() ? 0 : events[ 0 ].start;
+	fprintf( f, "{\"traceEvents\":[\n" );
+	for( size_t i = 0; i < events.size(); i++ ) {
+		const traceEvent_t& e = events[ i ];
+		std::map< std::string, int >::const_iterator row = rows.find( e.node );
+		if ( row == rows.end() ) {
+			row = rows.insert( std::make_pair( e.node, (int)rows.size() + 1 ) ).first;
+		}
+		fprintf( f, "%s{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"node\":\"%s\"}}",
+				 i > 0 ? ",\n" : "",
+				 e.stage, e.nodeType.c_str(), row->second,
+				 ( e.start - origin ) * 1e6, e.duration * 1e6,
+				 e.node.c_str() );
+	}
+	for( std::map< std::string, int >::const_iterator row = rows.begin(); row != rows.end(); ++row ) {
+		fprintf( f, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"%s\"}}",
+				 row->second, row->first.c_str() );
+	}
+	fprintf( f, "\n],\"displayTimeUnit\":\"ms\"}\n" );
+
+	const bool ok = ferror( f ) == 0;
+	fclose( f );
+	return ok ? MS::kSuccess : MS::kFailure;
+}
+
+//////////////////////////////////////////////////////////////////////////
+// Counter attributes
+//////////////////////////////////////////////////////////////////////////
+
+MObject CreateStatAttribute( const char* name, const char* shortName, MStatus& stat ) {
+	MFnNumericAttribute nAttr;
+	MObject attribute = nAttr.create( name, shortName, MFnNumericData::kDouble, 0.0, &stat );
+	if ( !stat ) return attribute;
+	nAttr.setWritable( false );
+	nAttr.setStorable( false );
+	return attribute;
+}
+
+void SetStat( MDataBlock& data, const MObject& attribute, double value ) {
+	MDataHandle handle = data.outputValue( attribute );
+	handle.set( value );
+	handle.setClean();
+}
+
+//////////////////////////////////////////////////////////////////////////
+// StatTimer
+//////////////////////////////////////////////////////////////////////////
+
+StatTimer::StatTimer( const char* stageName, const MObject& timedNode ) :
+	stage( stageName ),
+	node( timedNode ),
+	start( ProfileSeconds() ) {
+}
+
+double StatTimer::Stop() {
+	const double end = ProfileSeconds();
+
+	MFnDependencyNode fnNode( node );
+	traceEvent_t e;
+	e.stage		= stage;
+	e.nodeType	= fnNode.typeName().asChar();
+	e.node		= fnNode.name().asChar();
+	e.start		= start;
+	e.duration	= end - start;
+	RecordTraceEvent( e );
+
+	return ( end - start ) * 1000.0;
+}
+
+//////////////////////////////////////////////////////////////////////////
+// GrowerStatsCmd
+//////////////////////////////////////////////////////////////////////////
+
+const MString GrowerStatsCmd::commandName( "growerStats" );
+
+#define TRACE_FLAG				"-t"
+#define TRACE_FLAG_LONG			"-trace"
+#define CLEAR_TRACE_FLAG		"-ct"
+#define CLEAR_TRACE_FLAG_LONG	"-clearTrace"
+
+static bool HasStats( const MObject& node ) {
+	const MTypeId id = MFnDependencyNode( node ).typeId();
+	return id == Sampler::id || id == Grower::id || id == Trimmer::id || id == GrowerShape::id;
+}
+
+static MString FormatNumber( double value ) {
+	char buf[ 64 ];
+	sprintf( buf, "%.6g", value );
+	return MString( buf );
+}
+
+MStatus GrowerStatsCmd::doIt( const MArgList& args ) {
+	MStatus stat;
+	MArgDatabase argData( syntax(), args, &stat );
+	if ( !stat ) return stat;
+
+	// the nodes given, or their shapes, otherwise every node with counters
+	std::vector< MObject > nodes;
+	MSelectionList sel;
+	argData.getObjects( sel );
+	if ( sel.length() > 0 ) {
+		for( unsigned int i = 0; i < sel.length(); i++ ) {
+			MObject node;
+			sel.getDependNode( i, node );
+			MDagPath path;
+			if ( !HasStats( node ) && sel.getDagPath( i, path ) && path.extendToShape() ) {
+				node = path.node();
+			}
+			if ( !HasStats( node ) ) {
+				displayError( MFnDependencyNode( node ).name() + " is not a Sampler, Grower, Trimmer or GrowerShape node." );
+				return MS::kFailure;
+			}
+			nodes.push_back( node );
+		}
+	} else {
+		for( MItDependencyNodes it; !it.isDone(); it.next() ) {
+			MObject node = it.thisNode();
+			if ( HasStats( node ) ) {
+				nodes.push_back( node );
+			}
+		}
+	}
+
+	// { "node": { "statAttribute": value, ... }, ... }
+	MString result = "{";
+	for( size_t i = 0; i < nodes.size(); i++ ) {
+		MFnDependencyNode fnNode( nodes[ i ] );
+		result += MString( i > 0 ? ", " : "" ) + "\"" + fnNode.name() + "\": {";
+		bool first = true;
+		for( unsigned int a = 0; a < fnNode.attributeCount(); a++ ) {
+			MObject attribute = fnNode.attribute( a );
+			const MString name = MFnAttribute( attribute ).name();
+			if ( name.length() <= 4 || name.substring( 0, 3 ) != "stat" ) continue;
+			const double value = fnNode.findPlug( attribute ).asDouble();
+			result += MString( first ? "" : ", " ) + "\"" + name + "\": " + FormatNumber( value );
+			first = false;
+		}
+		result += "}";
+	}
+	result += "}";
+
+	if ( argData.isFlagSet( TRACE_FLAG ) ) {
+		MString path;
+		argData.getFlagArgument( TRACE_FLAG, 0, path );
+		stat = WriteTrace( path );
+		if ( !stat ) {
+			displayError( "Could not write the trace to " + path );
+			return stat;
+		}
+	}
+	if ( argData.isFlagSet( CLEAR_TRACE_FLAG ) ) {
+		ClearTrace();
+	}
+
+	setResult( result );
+	return MS::kSuccess;
+}
+
+void* GrowerStatsCmd::creator() {
+	return new GrowerStatsCmd;
+}
+
+MSyntax GrowerStatsCmd::syntax() {
+	MSyntax cmdSyntax;
+	cmdSyntax.addFlag( TRACE_FLAG, TRACE_FLAG_LONG, MSyntax::kString );
+	cmdSyntax.addFlag( CLEAR_TRACE_FLAG, CLEAR_TRACE_FLAG_LONG );
+	cmdSyntax.useSelectionAsDefault( false );
+	cmdSyntax.setObjectType( MSyntax::kSelectionList, 0 );
+	return cmdSyntax;
+}
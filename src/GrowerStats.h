@@ -0,0 +1,74 @@
+/* 
+	================================================================================
+	Copyright (c) 2012, Jose Esteve. http://www.joesfer.com
+	This software is released under the LGPL-3.0 license: http://www.opensource.org/licenses/lgpl-3.0.html	
+	================================================================================
+*/
+
+#ifndef GrowerStats_h__
+#define GrowerStats_h__
+
+#include <maya/MPxCommand.h>
+#include <maya/MSyntax.h>
+#include <maya/MObject.h>
+#include <maya/MString.h>
+#include <maya/MDataBlock.h>
+
+//////////////////////////////////////////////////////////////////////////
+//
+// Profiling
+//
+//	Each node exposes the counters of its last evaluation as read-only
+//	attributes prefixed with "stat" (times in milliseconds, memory in
+//	bytes), the compute time leaving out the evaluation of the node's
+//	inputs. The stages timed with a StatTimer are also logged into a
+//	process-wide trace, which the growerStats command can dump in the
+//	Chrome trace event format (open it in chrome://tracing).
+//
+//////////////////////////////////////////////////////////////////////////
+
+// Creates a read-only, non-storable double attribute for a counter
+MObject	CreateStatAttribute( const char* name, const char* shortName, MStatus& stat );
+
+// Writes a counter attribute, leaving it clean
+void	SetStat( MDataBlock& data, const MObject& attribute, double value );
+
+class StatTimer {
+public:
+			StatTimer( const char* stage, const MObject& node );
+
+	// Logs the stage into the trace, returns the elapsed milliseconds
+	double	Stop();
+
+private:
+	const char*	stage;	// static string
+	MObject		node;
+	double		start;	// seconds
+};
+
+/////////////////////////////////////////////////////////////////////
+//
+// class GrowerStatsCmd
+//
+//	growerStats [-trace path] [-clearTrace] [nodes]
+//
+//	Returns the counters of the given Sampler, Grower, Trimmer and
+//	GrowerShape nodes (all of them by default) as a JSON string.
+//
+/////////////////////////////////////////////////////////////////////
+
+class GrowerStatsCmd : public MPxCommand {
+public:
+	// overrides
+	virtual MStatus   	doIt( const MArgList& args );
+	virtual bool		isUndoable() const { return false; }
+	virtual bool		hasSyntax() const { return true; }
+
+	// methods
+	static  void*		creator();
+	static	MSyntax		syntax();
+
+	static const MString	commandName;
+};
+
+#endif // GrowerStats_h__
@@ -0,0 +1,269 @@
+/* 
+	================================================================================
+	Copyright (c) 2012, Jose Esteve. http://www.joesfer.com
+	This software is released under the LGPL-3.0 license: http://www.opensource.org/licenses/lgpl-3.0.html	
+	================================================================================
+*/
+#include "GrowerSubSceneOverride.h"
+#include "GrowerShape.h"
+#include "GrowerData.h"
+#include "core/Hash.h"
+
+#include <maya/MPlug.h>
+
+#include <maya/MFnDependencyNode.h>
+#include <maya/MDagPath.h>
+#include <maya/MBoundingBox.h>
+#include <maya/MViewport2Renderer.h>
+
+#include <string.h>
+
+#define SEGMENTS_ITEM_NAME	"growerSegments"
+#define POINTS_ITEM_NAME	"growerPoints"
+
+const MString GrowerSubSceneOverride::drawDbClassification( "drawdb/subscene/growerShape" );
+const MString GrowerSubSceneOverride::registrantId( "GrowerSubSceneOverride" );
+
+MHWRender::MPxSubSceneOverride* GrowerSubSceneOverride::Creator( const MObject& obj ) {
+	return new GrowerSubSceneOverride( obj );
+}
+
+GrowerSubSceneOverride::GrowerSubSceneOverride( const MObject& obj ) :
+	MHWRender::MPxSubSceneOverride( obj ),
+	m_node( obj ),
+	m_shape( NULL ),
+	m_segmentShader( NULL ),
+	m_pointShader( NULL ),
+	m_positions( NULL ),
+	m_segments( NULL ),
+	m_points( NULL ),
+	m_geometryVersion( 0 ),
+	m_topologyHash( 0 ),
+	m_numNodes( 0 ) {
+
+	MFnDependencyNode fnNode( obj );
+	m_shape = (GrowerShape*)fnNode.userNode();
+
+	// same colors as the legacy viewport
+	MHWRender::MRenderer* renderer = MHWRender::MRenderer::theRenderer();
+	const MHWRender::MShaderManager* shaderManager = renderer != NULL ? renderer->getShaderManager() : NULL;
+	if ( shaderManager != NULL ) {
+		const float red[ 4 ] = { 1.0f, 0.0f, 0.0f, 1.0f };
+		m_segmentShader = shaderManager->getStockShader( MHWRender::MShaderManager::k3dSolidShader );
+		if ( m_segmentShader != NULL ) {
+			m_segmentShader->setParameter( "solidColor", red );
+		}
+#if GROWER_DISPLAY_DEBUG_INFO
+		const float white[ 4 ] = { 1.0f, 1.0f, 1.0f, 1.0f };
+		m_pointShader = shaderManager->getStockShader( MHWRender::MShaderManager::k3dSolidShader );
+		if ( m_pointShader != NULL ) {
+			m_pointShader->setParameter( "solidColor", white );
+		}
+#endif
+	}
+}
+
+GrowerSubSceneOverride::~GrowerSubSceneOverride() {
+	ReleaseBuffers();
+
+	MHWRender::MRenderer* renderer = MHWRender::MRenderer::theRenderer();
+	const MHWRender::MShaderManager* shaderManager = renderer != NULL ? renderer->getShaderManager() : NULL;
+	if ( shaderManager != NULL ) {
+		if ( m_segmentShader != NULL ) {
+			shaderManager->releaseShader( m_segmentShader );
+		}
+		if ( m_pointShader != NULL ) {
+			shaderManager->releaseShader( m_pointShader );
+		}
+	}
+}
+
+MHWRender::DrawAPI GrowerSubSceneOverride::supportedDrawAPIs() const {
+	// no direct GL calls, so it draws under every device, including the
+	// batch / offscreen playblast ones
+	return MHWRender::kAllDevices;
+}
+
+bool GrowerSubSceneOverride::requiresUpdate( const MHWRender::MSubSceneContainer& /*container*/, const MHWRender::MFrameContext& frameContext ) const {
+	if ( m_shape == NULL ) {
+		return false;
+	}
+	return m_shape->GeometryVersion() != m_geometryVersion || 
+		   InstancesChanged() ||
+		   m_lod.NeedsSelect( Tolerance( frameContext ), Density() );
+}
+
+// Level of detail tolerance for the current view, taken at the first instance
+float GrowerSubSceneOverride::Tolerance( const MHWRender::MFrameContext& frameContext ) const {
+	MDagPathArray instances;
+	MDagPath::getAllPathsTo( m_node, instances );
+	if ( instances.length() == 0 ) {
+		return 0;
+	}
+	const MMatrix worldView = instances[ 0 ].inclusiveMatrix() * frameContext.getMatrix( MHWRender::MFrameContext::kViewMtx );
+	const MMatrix projection = frameContext.getMatrix( MHWRender::MFrameContext::kProjectionMtx );
+	int originX, originY, width, height;
+	frameContext.getViewportDimensions( originX, originY, width, height );
+	return LOD_PIXEL_ERROR * GrowerWireframeLOD::PixelSize( m_bounds, worldView, projection, height );
+}
+
+float GrowerSubSceneOverride::Density() const {
+	return MPlug( m_node, GrowerShape::displayDensity ).asFloat();
+}
+
+// Whether the shape got instanced, or any of its instances moved
+bool GrowerSubSceneOverride::InstancesChanged() const {
+	MDagPathArray instances;
+	MDagPath::getAllPathsTo( m_node, instances );
+	if ( instances.length() != m_instances.length() ) {
+		return true;
+	}
+	for( unsigned int i = 0; i < instances.length(); i++ ) {
+		if ( !( instances[ i ] == m_instances[ i ] ) ||
+			 !( instances[ i ].inclusiveMatrix() == m_instanceMatrices[ i ] ) ) {
+			return true;
+		}
+	}
+	return false;
+}
+
+void GrowerSubSceneOverride::update( MHWRender::MSubSceneContainer& container, const MHWRender::MFrameContext& frameContext ) {
+	if ( m_shape == NULL || m_segmentShader == NULL ) {
+		return;
+	}
+
+	bool rebuildItems = false;
+	if ( m_shape->GeometryVersion() != m_geometryVersion ) {
+		rebuildItems = UpdateBuffers( container );
+		m_geometryVersion = m_shape->GeometryVersion();
+	}
+	if ( m_positions == NULL ) {
+		container.clear();
+		m_instances.clear();
+		m_instanceMatrices.clear();
+		return;
+	}
+
+	MDagPathArray instances;
+	MDagPath::getAllPathsTo( m_node, instances );
+	if ( instances.length() != m_instances.length() ) {
+		rebuildItems = true;
+	}
+	m_instances = instances;
+	m_instanceMatrices.resize( m_instances.length() );
+
+	// one render item per instance, all of them sharing the same buffers.
+	// Items are only created again if the buffers or the instances did 
+	// change, otherwise they're just pointed at the updated data.
+	if ( rebuildItems ) {
+		container.clear();
+	}
+
+	// the segments actually drawn depend on the view and display density
+	if ( m_lod.Select( Tolerance( frameContext ), Density() ) ) {
+		const std::vector< unsigned int >& segments = m_lod.Segments();
+		if ( !segments.empty() ) {
+			void* segmentData = m_segments->acquire( (unsigned int)segments.size(), true );
+			if ( segmentData != NULL ) {
+				memcpy( segmentData, &segments[ 0 ], segments.size() * sizeof( unsigned int ) );
+				m_segments->commit( segmentData );
+			}
+		}
+	}
+	const bool drawSegments = !m_lod.Segments().empty();
+
+	const MBoundingBox* bounds = &m_bounds;
+	MHWRender::MVertexBufferArray vertexBuffers;
+	vertexBuffers.addBuffer( "positions", m_positions );
+
+	for( unsigned int i = 0; i < m_instances.length(); i++ ) {
+		m_instanceMatrices[ i ] = m_instances[ i ].inclusiveMatrix();
+
+		MString name( SEGMENTS_ITEM_NAME );
+		name += (int)i;
+		MHWRender::MRenderItem* segments = container.find( name );
+		if ( segments == NULL ) {
+			segments = MHWRender::MRenderItem::Create( name, MHWRender::MGeometry::kLines, MHWRender::MGeometry::kAll, false );
+			segments->setShader( m_segmentShader );
+			container.add( segments );
+		}
+		segments->setMatrix( &m_instanceMatrices[ i ] );
+		segments->enable( drawSegments );
+		if ( drawSegments ) {
+			setGeometryForRenderItem( *segments, vertexBuffers, *m_segments, bounds );
+		}
+
+		if ( m_pointShader != NULL && m_points != NULL ) {
+			MString pointsName( POINTS_ITEM_NAME );
+			pointsName += (int)i;
+			MHWRender::MRenderItem* points = container.find( pointsName );
+			if ( points == NULL ) {
+				points = MHWRender::MRenderItem::Create( pointsName, MHWRender::MGeometry::kPoints, MHWRender::MGeometry::kAll, false );
+				points->setShader( m_pointShader );
+				container.add( points );
+			}
+			points->setMatrix( &m_instanceMatrices[ i ] );
+			setGeometryForRenderItem( *points, vertexBuffers, *m_points, bounds );
+		}
+	}
+}
+
+// Uploads the node positions, and rebuilds the level of detail polylines.
+// Returns whether the buffers were allocated again, in which case the 
+// render items referencing the old ones are removed.
+bool GrowerSubSceneOverride::UpdateBuffers( MHWRender::MSubSceneContainer& container ) {
+	const GrowerData* data = m_shape->MeshGeometry();
+	if ( data == NULL || data->nodes.segments.empty() ) {
+		container.clear();
+		ReleaseBuffers();
+		return true;
+	}
+	const growerNodes_t& nodes = data->nodes;
+	const size_t numNodes = nodes.Size();
+	m_bounds = data->bounds;
+	m_lod.Update( nodes, m_shape->GeometryVersion() );
+
+	bool reallocated = false;
+	const MUint64 topologyHash = HashBytes( HASH_SEED, &nodes.segments[ 0 ], nodes.segments.size() * sizeof( unsigned int ) );
+	if ( m_positions == NULL || numNodes != m_numNodes || topologyHash != m_topologyHash ) {
+		container.clear();
+		ReleaseBuffers();
+		reallocated = true;
+
+		const MHWRender::MVertexBufferDescriptor positionDesc( "", MHWRender::MGeometry::kPosition, MHWRender::MGeometry::kFloat, 3 );
+		m_positions = new MHWRender::MVertexBuffer( positionDesc );
+
+		// filled once the level of detail is selected
+		m_segments = new MHWRender::MIndexBuffer( MHWRender::MGeometry::kUnsignedInt32 );
+
+		if ( m_pointShader != NULL ) {
+			m_points = new MHWRender::MIndexBuffer( MHWRender::MGeometry::kUnsignedInt32 );
+			void* pointData = m_points->acquire( (unsigned int)nodes.children.size(), true );
+			if ( pointData != NULL ) {
+				memcpy( pointData, &nodes.children[ 0 ], nodes.children.size() * sizeof( unsigned int ) );
+				m_points->commit( pointData );
+			}
+		}
+
+		m_numNodes = numNodes;
+		m_topologyHash = topologyHash;
+	}
+
+	void* positionData = m_positions->acquire( (unsigned int)numNodes, true );
+	if ( positionData != NULL ) {
+		memcpy( positionData, &nodes.pos[ 0 ], 3 * numNodes * sizeof( float ) );
+		m_positions->commit( positionData );
+	}
+	return reallocated;
+}
+
+void GrowerSubSceneOverride::ReleaseBuffers() {
+	delete m_positions;
+	delete m_segments;
+	delete m_points;
+	m_positions = NULL;
+	m_segments = NULL;
+	m_points = NULL;
+	m_numNodes = 0;
+	m_topologyHash = 0;
+}
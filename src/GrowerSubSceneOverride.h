@@ -0,0 +1,82 @@
+/* 
+	================================================================================
+	Copyright (c) 2012, Jose Esteve. http://www.joesfer.com
+	This software is released under the LGPL-3.0 license: http://www.opensource.org/licenses/lgpl-3.0.html	
+	================================================================================
+*/
+
+#ifndef GrowerSubSceneOverride_h__
+#define GrowerSubSceneOverride_h__
+
+#include <maya/MPxSubSceneOverride.h>
+#include <maya/MHWGeometry.h>
+#include <maya/MShaderManager.h>
+#include <maya/MDagPathArray.h>
+#include <maya/MMatrix.h>
+#include <maya/MTypes.h>
+#include <maya/MBoundingBox.h>
+#include <vector>
+
+#include "GrowerWireframeLOD.h"
+
+class GrowerShape;
+
+/////////////////////////////////////////////////////////////////////
+//
+// class GrowerSubSceneOverride
+//
+//	Viewport 2.0 counterpart of GrowerShapeUI. The branch segments are
+//	kept as persistent render items (one per instance) sharing a single
+//	vertex and index buffer. The index buffer is only rebuilt when the
+//	hierarchy changes, otherwise the node positions are rewritten in
+//	place. The segment indices follow the wireframe level of detail.
+//	The tube mesh is drawn by the mesh node GrowerShape feeds.
+//
+/////////////////////////////////////////////////////////////////////
+
+class GrowerSubSceneOverride : public MHWRender::MPxSubSceneOverride
+{
+public:
+	static MHWRender::MPxSubSceneOverride*	Creator( const MObject& obj );
+
+	virtual						~GrowerSubSceneOverride();
+
+	// overrides
+
+	virtual MHWRender::DrawAPI	supportedDrawAPIs() const;
+	virtual bool				requiresUpdate( const MHWRender::MSubSceneContainer& container, const MHWRender::MFrameContext& frameContext ) const;
+	virtual void				update( MHWRender::MSubSceneContainer& container, const MHWRender::MFrameContext& frameContext );
+
+public:
+	static const MString		drawDbClassification;
+	static const MString		registrantId;
+
+private:
+								GrowerSubSceneOverride( const MObject& obj );
+
+	bool						InstancesChanged() const;
+	float						Tolerance( const MHWRender::MFrameContext& frameContext ) const;
+	float						Density() const;
+	bool						UpdateBuffers( MHWRender::MSubSceneContainer& container );
+	void						ReleaseBuffers();
+
+	MObject						m_node;
+	GrowerShape*				m_shape;
+
+	MHWRender::MShaderInstance*	m_segmentShader;
+	MHWRender::MShaderInstance*	m_pointShader;
+	MHWRender::MVertexBuffer*	m_positions;
+	MHWRender::MIndexBuffer*	m_segments;
+	MHWRender::MIndexBuffer*	m_points;
+
+	// state the buffers and render items were built from
+	unsigned int				m_geometryVersion;
+	MUint64						m_topologyHash;
+	size_t						m_numNodes;
+	MDagPathArray				m_instances;
+	std::vector< MMatrix >		m_instanceMatrices;
+	MBoundingBox				m_bounds;
+	GrowerWireframeLOD			m_lod;
+};
+
+#endif // GrowerSubSceneOverride_h__
@@ -0,0 +1,182 @@
+/* 
+	================================================================================
+	Copyright (c) 2012, Jose Esteve. http://www.joesfer.com
+	This software is released under the LGPL-3.0 license: http://www.opensource.org/licenses/lgpl-3.0.html	
+	================================================================================
+*/
+#include "GrowerWireframeLOD.h"
+#include "GrowerData.h"
+
+#include <float.h>
+#include <limits.h>
+#include <math.h>
+#include <algorithm>
+
+GrowerWireframeLOD::GrowerWireframeLOD() : 
+	m_valid( false ),
+	m_version( 0 ),
+	m_maxThickness( 1.0f ),
+	m_toleranceLevel( 0 ),
+	m_density( -1.0f ) {
+}
+
+void GrowerWireframeLOD::Update( const growerNodes_t& nodes, unsigned int version ) {
+	if ( m_valid && version == m_version ) {
+		return;
+	}
+	m_valid = true;
+	m_version = version;
+	m_density = -1.0f; // force the selection to be made again
+
+	const size_t numNodes = nodes.Size();
+
+	// pipe model thickness, parents always precede their children
+	std::vector< float > thickness( numNodes, 1.0f );
+	for( size_t i = numNodes; i-- > 0; ) {
+		const unsigned int numChildren = nodes.NumChildren( i );
+		if ( numChildren > 0 ) {
+			float sqThickness = 0;
+			for( unsigned int j = 0; j < numChildren; j++ ) {
+				const float t = thickness[ nodes.Child( i, j ) ];
+				sqThickness += t * t;
+			}
+			thickness[ i ] = sqrtf( sqThickness );
+		}
+	}
+
+	// a polyline starts at every child of a node which doesn't have a 
+	// single child, and runs down until the next such node
+	m_polylineOffsets.resize( 0 );
+	m_polylineNodes.resize( 0 );
+	m_polylineErrors.resize( 0 );
+	m_polylineThickness.resize( 0 );
+	m_maxThickness = 1.0f;
+	for( size_t i = 0; i < numNodes; i++ ) {
+		const unsigned int numChildren = nodes.NumChildren( i );
+		const unsigned int parent = nodes.parent[ i ];
+		if ( numChildren == 1 && parent != INVALID_PARENT ) {
+			continue; // inner polyline node
+		}
+		for( unsigned int j = 0; j < numChildren; j++ ) {
+			const size_t first = m_polylineNodes.size();
+			m_polylineOffsets.push_back( (unsigned int)first );
+			m_polylineNodes.push_back( (unsigned int)i );
+			unsigned int node = nodes.Child( i, j );
+			m_polylineThickness.push_back( thickness[ node ] );
+			m_maxThickness = std::max( m_maxThickness, thickness[ node ] );
+			m_polylineNodes.push_back( node );
+			while( nodes.NumChildren( node ) == 1 ) {
+				node = nodes.Child( node, 0 );
+				m_polylineNodes.push_back( node );
+			}
+			m_polylineErrors.resize( m_polylineNodes.size() );
+			SimplifyPolyline( nodes, first, m_polylineNodes.size() - 1 );
+		}
+	}
+	m_polylineOffsets.push_back( (unsigned int)m_polylineNodes.size() );
+}
+
+// Douglas-Peucker over the polyline nodes [ first, last ], iteratively. 
+// The error of each node is the distance which made it split its range,
+// clamped to the error of the node splitting the enclosing range so that
+// nodes are always dropped before the ones they depend on.
+void GrowerWireframeLOD::SimplifyPolyline( const growerNodes_t& nodes, size_t first, size_t last ) {
+	m_polylineErrors[ first ] = FLT_MAX;
+	m_polylineErrors[ last ] = FLT_MAX;
+
+	m_stack.resize( 0 );
+	m_stack.push_back( std::make_pair( first, last ) );
+	while( !m_stack.empty() ) {
+		const size_t a = m_stack.back().first;
+		const size_t b = m_stack.back().second;
+		m_stack.pop_back();
+		if ( b <= a + 1 ) {
+			continue;
+		}
+
+		const vec3_t pa = nodes.Pos( m_polylineNodes[ a ] );
+		const vec3_t pb = nodes.Pos( m_polylineNodes[ b ] );
+		vec3_t ab = pb - pa;
+		const double abLength = ab.length();
+		if ( abLength > 0 ) {
+			ab /= abLength;
+		}
+		double maxDist = -1;
+		size_t split = a + 1;
+		for( size_t k = a + 1; k < b; k++ ) {
+			const vec3_t ap = nodes.Pos( m_polylineNodes[ k ] ) - pa;
+			const double dist = ( ap - ab * ( ap * ab ) ).length();
+			if ( dist > maxDist ) {
+				maxDist = dist;
+				split = k;
+			}
+		}
+
+		const float enclosingError = std::min( m_polylineErrors[ a ], m_polylineErrors[ b ] );
+		m_polylineErrors[ split ] = std::min( (float)maxDist, enclosingError );
+		m_stack.push_back( std::make_pair( a, split ) );
+		m_stack.push_back( std::make_pair( split, b ) );
+	}
+}
+
+// Tolerances are snapped to powers of sqrt(2), so the selection is only 
+// made again when the view changes significantly
+int GrowerWireframeLOD::ToleranceLevel( float tolerance ) {
+	return tolerance > 0 ? (int)floorf( 2.0f * logf( tolerance ) / logf( 2.0f ) ) : INT_MIN;
+}
+
+bool GrowerWireframeLOD::NeedsSelect( float tolerance, float density ) const {
+	density = std::max( 0.0f, std::min( 1.0f, density ) );
+	return ToleranceLevel( tolerance ) != m_toleranceLevel || density != m_density;
+}
+
+bool GrowerWireframeLOD::Select( float tolerance, float density ) {
+	if ( !NeedsSelect( tolerance, density ) ) {
+		return false;
+	}
+	const int toleranceLevel = ToleranceLevel( tolerance );
+	density = std::max( 0.0f, std::min( 1.0f, density ) );
+	m_toleranceLevel = toleranceLevel;
+	m_density = density;
+
+	const float snappedTolerance = toleranceLevel != INT_MIN ? powf( 2.0f, 0.5f * toleranceLevel ) : 0.0f;
+	const float minThickness = powf( m_maxThickness, 1.0f - density );
+
+	m_segments.resize( 0 );
+	const size_t numPolylines = m_polylineThickness.size();
+	for( size_t i = 0; i < numPolylines; i++ ) {
+		if ( m_polylineThickness[ i ] < minThickness ) {
+			continue;
+		}
+		const unsigned int first = m_polylineOffsets[ i ];
+		const unsigned int last = m_polylineOffsets[ i + 1 ] - 1;
+		unsigned int prev = first;
+		for( unsigned int k = first + 1; k <= last; k++ ) {
+			if ( m_polylineErrors[ k ] > snappedTolerance ) {
+				m_segments.push_back( m_polylineNodes[ prev ] );
+				m_segments.push_back( m_polylineNodes[ k ] );
+				prev = k;
+			}
+		}
+	}
+	return true;
+}
+
+float GrowerWireframeLOD::PixelSize( const MBoundingBox& bounds, const MMatrix& worldView, const MMatrix& projection, int viewportHeight ) {
+	if ( viewportHeight <= 0 || projection[ 1 ][ 1 ] == 0 ) {
+		return 0;
+	}
+	// perspective projections scale with the distance to the eye (looking
+	// down -z), orthographic ones don't
+	double depth = 1.0;
+	if ( projection[ 3 ][ 3 ] == 0 ) {
+		const MPoint bmin = bounds.min();
+		const MPoint bmax = bounds.max();
+		depth = DBL_MAX;
+		for( int i = 0; i < 8; i++ ) {
+			const MPoint corner( ( i & 1 ) ? bmax.x : bmin.x, ( i & 2 ) ? bmax.y : bmin.y, ( i & 4 ) ? bmax.z : bmin.z );
+			depth = std::min( depth, std::max( 0.0, -( corner * worldView ).z ) );
+		}
+	}
+	return (float)( 2.0 * depth / ( fabs( projection[ 1 ][ 1 ] ) * viewportHeight ) );
+}
@@ -0,0 +1,78 @@
+/* 
+	================================================================================
+	Copyright (c) 2012, Jose Esteve. http://www.joesfer.com
+	This software is released under the LGPL-3.0 license: http://www.opensource.org/licenses/lgpl-3.0.html	
+	================================================================================
+*/
+
+#ifndef GrowerWireframeLOD_h__
+#define GrowerWireframeLOD_h__
+
+#include <maya/MMatrix.h>
+#include <maya/MBoundingBox.h>
+#include <vector>
+
+struct growerNodes_t;
+
+/////////////////////////////////////////////////////////////////////
+//
+// class GrowerWireframeLOD
+//
+//	Level of detail for the wireframe preview. The hierarchy is split 
+//	into polylines running between branching nodes (or leaves), which 
+//	are simplified by Douglas-Peucker: every polyline node records the 
+//	largest error tolerance it survives, so picking the nodes for a 
+//	given tolerance is a single pass without simplifying again. The 
+//	tolerance is derived from the size of a screen pixel at the shape.
+//
+//	Besides, the display density culls the thinnest branches, using 
+//	the pipe model thickness: leaves are 1 and a node's squared 
+//	thickness is the sum of its children's. A density of 1 draws every
+//	branch, a density of 0 only the thickest one.
+// 
+/////////////////////////////////////////////////////////////////////
+
+#define LOD_PIXEL_ERROR		1.0f	// screen space error allowed, in pixels
+
+class GrowerWireframeLOD {
+public:
+				GrowerWireframeLOD();
+
+	// Rebuilds the polylines whenever version (GrowerShape::GeometryVersion)
+	// changes.
+	void		Update( const growerNodes_t& nodes, unsigned int version );
+
+	// Selects the segments to draw for the given tolerance and density,
+	// returns false if they didn't change since the last call.
+	bool		Select( float tolerance, float density );
+	bool		NeedsSelect( float tolerance, float density ) const;
+
+	// ( node, node ) index pairs selected by the last call to Select
+	const std::vector< unsigned int >&	Segments() const { return m_segments; }
+
+	// Size of a pixel at the closest point of the given object space 
+	// bounds (ignoring the object scale)
+	static float PixelSize( const MBoundingBox& bounds, const MMatrix& worldView, const MMatrix& projection, int viewportHeight );
+
+private:
+	void		SimplifyPolyline( const growerNodes_t& nodes, size_t first, size_t last );
+	static int	ToleranceLevel( float tolerance );
+
+	bool							m_valid;
+	unsigned int					m_version;
+
+	// polyline i spans [ m_polylineOffsets[ i ], m_polylineOffsets[ i + 1 ] )
+	std::vector< unsigned int >		m_polylineOffsets;
+	std::vector< unsigned int >		m_polylineNodes;
+	std::vector< float >			m_polylineErrors;		// per polyline node, FLT_MAX at the ends
+	std::vector< float >			m_polylineThickness;	// pipe model thickness of each polyline
+	float							m_maxThickness;
+
+	// last selection
+	int								m_toleranceLevel;
+	float							m_density;
+	std::vector< unsigned int >		m_segments;
+	std::vector< std::pair< size_t, size_t > >	m_stack;
+};
+
+#endif // GrowerWireframeLOD_h__
@@ -0,0 +1,99 @@
+/* 
+	================================================================================
+	Copyright (c) 2012, Jose Esteve. http://www.joesfer.com
+	This software is released under the LGPL-3.0 license: http://www.opensource.org/licenses/lgpl-3.0.html	
+	================================================================================
+*/
+
+#include "MayaTaskRunner.h"
+
+#include <maya/MThreadPool.h>
+#include <maya/MThreadUtils.h>
+#include <algorithm>
+#include <vector>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <pthread.h>
+#endif
+
+// binds a core task function to its task description
+struct mayaTask_t {
+	taskFunc_t	func;
+	void*		task;
+};
+
+struct mayaTaskRegion_t {
+	mayaTask_t*	tasks;
+	size_t		numTasks;
+};
+
+static MThreadRetVal RunMayaTask( void* data ) {
+	const mayaTask_t* task = (const mayaTask_t*)data;
+	task->func( task->task );
+	return 0;
+}
+
+static void RunMayaTaskRegion( void* data, MThreadRootTask* root ) {
+	mayaTaskRegion_t* region = (mayaTaskRegion_t*)data;
+	for( size_t i = 0; i < region->numTasks; i++ ) {
+		MThreadPool::createTask( RunMayaTask, &region->tasks[ i ], root );
+	}
+	MThreadPool::executeAndJoin( root );
+}
+
+MayaTaskRunner::MayaTaskRunner() {
+	threadPoolReady = ( MThreadPool::init() == MS::kSuccess );
+}
+
+MayaTaskRunner::~MayaTaskRunner() {
+	if ( threadPoolReady ) {
+		MThreadPool::release();
+	}
+}
+
+// a few more tasks than threads so that the workload is balanced even if
+// some of the tasks take longer than others
+size_t MayaTaskRunner::MaxTasks() const {
+	return threadPoolReady ? (size_t)std::max( 1, 4 * MThreadUtils::getNumThreads() ) : 1;
+}
+
+void MayaTaskRunner::Run( taskFunc_t func, void* tasks, size_t taskSize, size_t numTasks ) const {
+	if ( !threadPoolReady || numTasks <= 1 ) {
+		TaskRunner::Run( func, tasks, taskSize, numTasks );
+		return;
+	}
+
+	std::vector< mayaTask_t > mayaTasks( numTasks );
+	for( size_t i = 0; i < numTasks; i++ ) {
+		mayaTasks[ i ].func = func;
+		mayaTasks[ i ].task = (char*)tasks + i * taskSize;
+	}
+	mayaTaskRegion_t region;
+	region.tasks	= &mayaTasks[ 0 ];
+	region.numTasks	= numTasks;
+	MThreadPool::newParallelRegion( RunMayaTaskRegion, &region );
+}
+
+//////////////////////////////////////////////////////////////////////////
+// IsMainThread
+//
+//	The plugin library is loaded from the main thread, which is therefore
+//	the one initializing mainThread.
+//////////////////////////////////////////////////////////////////////////
+
+#ifdef _WIN32
+static const DWORD mainThread = GetCurrentThreadId();
+
+bool IsMainThread() {
+	return GetCurrentThreadId() == mainThread;
+}
+#else
+static const pthread_t mainThread = pthread_self();
+
+bool IsMainThread() {
+	return pthread_equal( pthread_self(), mainThread ) != 0;
+}
+#endif
@@ -0,0 +1,39 @@
+/* 
+	================================================================================
+	Copyright (c) 2012, Jose Esteve. http://www.joesfer.com
+	This software is released under the LGPL-3.0 license: http://www.opensource.org/licenses/lgpl-3.0.html	
+	================================================================================
+*/
+
+#ifndef MayaTaskRunner_h__
+#define MayaTaskRunner_h__
+
+#include "core/TaskRunner.h"
+
+//////////////////////////////////////////////////////////////////////////
+//
+// class MayaTaskRunner
+//
+//	Runs the core tasks on Maya's thread pool, one MThreadPool task each.
+//	The pool is initialized for the lifetime of the runner, falling back
+//	to running the tasks serially if it can't be.
+//
+//////////////////////////////////////////////////////////////////////////
+
+class MayaTaskRunner : public TaskRunner {
+public:
+					MayaTaskRunner();
+	virtual			~MayaTaskRunner();
+
+	virtual size_t	MaxTasks() const;
+	virtual void	Run( taskFunc_t func, void* tasks, size_t taskSize, size_t numTasks ) const;
+
+private:
+	bool			threadPoolReady;
+};
+
+// Whether the caller runs on the thread which loaded the plugin, Maya's
+// main thread, rather than on one of its evaluation threads
+bool IsMainThread();
+
+#endif // MayaTaskRunner_h__
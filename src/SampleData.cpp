@@ -0,0 +1,66 @@
+/* 
+	================================================================================
+	Copyright (c) 2012, Jose Esteve. http://www.joesfer.com
+	This software is released under the LGPL-3.0 license: http://www.opensource.org/licenses/lgpl-3.0.html	
+	================================================================================
+*/
+
+#include "SampleData.h"
+
+const MTypeId SampleData::id( 0x80768 );
+const MString SampleData::typeName( "SampleData" );
+
+//////////////////////////////////////////////////////////////////////////
+// SampleData::SampleData()
+//////////////////////////////////////////////////////////////////////////
+
+SampleData::SampleData() {
+}
+
+//////////////////////////////////////////////////////////////////////////
+// SampleData::~SampleData()
+//////////////////////////////////////////////////////////////////////////
+
+SampleData::~SampleData() {
+}
+
+//////////////////////////////////////////////////////////////////////////
+// SampleData::copy (override)
+//////////////////////////////////////////////////////////////////////////
+
+void SampleData::copy( const MPxData& other ) {
+	if ( &other != this && other.typeId() == id ) {
+		samples = ( (const SampleData&)other ).samples;
+	}
+}
+
+//////////////////////////////////////////////////////////////////////////
+// SampleData::typeId (override)
+//
+//	Binary tag used to identify this kind of data
+//////////////////////////////////////////////////////////////////////////
+
+MTypeId SampleData::typeId() const {
+	return SampleData::id;
+}
+
+//////////////////////////////////////////////////////////////////////////
+// SampleData::name (override)
+//
+//	String name used to identify this kind of data
+//////////////////////////////////////////////////////////////////////////
+
+MString SampleData::name() const {
+	return SampleData::typeName;
+}
+
+//////////////////////////////////////////////////////////////////////////
+// SampleData::creator
+//
+//	This method exists to give Maya a way to create new objects
+//	of this type. 
+//////////////////////////////////////////////////////////////////////////
+
+void * SampleData::creator() {
+	return new SampleData;
+}
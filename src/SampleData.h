@@ -0,0 +1,57 @@
+/* 
+	================================================================================
+	Copyright (c) 2012, Jose Esteve. http://www.joesfer.com
+	This software is released under the LGPL-3.0 license: http://www.opensource.org/licenses/lgpl-3.0.html	
+	================================================================================
+*/
+
+#ifndef SampleData_h__
+#define SampleData_h__
+
+#include <maya/MPxGeometryData.h>
+#include <maya/MTypeId.h>
+#include <maya/MTypes.h>
+#include <maya/MString.h>
+
+#include "core/SamplePoints.h"
+
+/////////////////////////////////////////////////////////////////////
+//
+// class SampleData
+//
+//	Hands the samples over from the Sampler to the Grower nodes without
+//	going through the (double precision) point and vector arrays.
+//
+/////////////////////////////////////////////////////////////////////
+
+class SampleData : public MPxGeometryData {
+
+public:
+	//////////////////////////////////////////////////////////////////
+	//
+	// Overrides from MPxData
+	//
+	//////////////////////////////////////////////////////////////////
+	SampleData();
+	virtual					~SampleData();
+
+	virtual	void			copy( const MPxData& );
+
+	virtual MTypeId         typeId() const;
+	virtual MString         name() const;
+
+	//////////////////////////////////////////////////////////////////
+	//
+	// Helper methods
+	//
+	//////////////////////////////////////////////////////////////////
+
+	static void *	creator();
+
+public:
+	static const MString typeName;
+	static const MTypeId id;
+
+	samplePoints_t samples;
+};
+#endif // SampleData_h__
@@ -52,6 +52,7 @@ const MTypeId SamplePreviewData::id(0x80299);
 const MString SamplePreviewData::typeName( "SamplePreviewData" );
 
 MObject     SampleShape::sampleData;
+MObject     SampleShape::displayStride;
 MObject     SampleShape::outData;
 
 //////////////////////////////////////////////////////////////////////
@@ -135,15 +136,20 @@ MStatus SampleShape::compute( const MPlug& plug, MDataBlock& data ) {
 			MCHECKERROR( stat, "compute : error getting proxy SamplePreviewData object")
 		}
 
-		// compute the output values			
+		// compute the output values, along with the bounding box for fast
+		// retrieval
 		MFnPointArrayData inputData;
 		inputData.setObject(inputDataObj);
-		newData->samples = inputData.array();
+		const MPointArray samples = inputData.array();
+		const unsigned int numSamples = samples.length();
 
-		// compute bounding box for fast retrieval
 		bounds.clear();			
-		for( unsigned int i = 0; i < newData->samples.length(); i += 2 ) {
-			bounds.expand( newData->samples[ i ] );
+		newData->positions.resize( 3 * numSamples );
+		for( unsigned int i = 0; i < numSamples; i++ ) {
+			newData->positions[ 3 * i ] = (float)samples[ i ].x;
+			newData->positions[ 3 * i + 1 ] = (float)samples[ i ].y;
+			newData->positions[ 3 * i + 2 ] = (float)samples[ i ].z;
+			bounds.expand( samples[ i ] );
 		}
 		
 		// Assign the new data to the outputSurface handle
@@ -236,6 +242,14 @@ MStatus SampleShape::initialize() {
 	typedAttr.setWritable( true );
 	typedAttr.setReadable( true );
 
+	// display only, it doesn't affect the output data
+	displayStride = nAttr.create( "displayStride", "dst", MFnNumericData::kInt, 1 );
+	nAttr.setWritable( true );
+	nAttr.setReadable( true );
+	nAttr.setStorable( true );
+	nAttr.setMin( 1 );
+	nAttr.setSoftMax( 100 );
+
 	outData = typedAttr.create( "output", "out", SamplePreviewData::id );
 	typedAttr.setWritable( false );
 	typedAttr.setStorable(false);
@@ -244,6 +258,7 @@ MStatus SampleShape::initialize() {
 	// Add the attributes to the node
 
 	addAttribute( sampleData );
+	addAttribute( displayStride );
 	addAttribute( outData );
 
 	// Set the attribute dependencies
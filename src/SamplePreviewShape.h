@@ -41,6 +41,7 @@
 #include <maya/MPxGeometryData.h>
 #include <maya/MTypeId.h>
 #include <maya/MString.h>
+#include <vector>
 
 class MPointArray;
 
@@ -98,8 +99,9 @@ public:
 	// the node will have.  These handles are needed for getting and setting
 	// the values later.
 	//
-	static MObject		sampleData;	// input sample data
-	static MObject		outData;	// output data
+	static MObject		sampleData;		// input sample data
+	static MObject		displayStride;	// only every n-th sample is drawn
+	static MObject		outData;		// output data
 
 private:
 	MBoundingBox		bounds;
@@ -116,7 +118,7 @@ private:
 class SamplePreviewData : public MPxGeometryData {
 public:
 
-	MPointArray& getSamples() { return samples; }
+	size_t	numSamples() const { return positions.size() / 3; }
 
 	// overrides 
 
@@ -132,5 +134,8 @@ public:
 	static const MString typeName;
 	static const MTypeId id;
 
-	MPointArray  samples;
+	// sample positions packed as 3 floats each, so that the viewport can
+	// draw them straight from this array. Only rebuilt when the input 
+	// samples change.
+	std::vector< float > positions;
 };
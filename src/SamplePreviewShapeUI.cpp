@@ -39,6 +39,7 @@
 #include <maya/MSelectionMask.h>
 #include <maya/MSelectionList.h>
 #include <maya/MDagPath.h>
+#include <maya/MPlug.h>
 
 // Object and component color defines
 //
@@ -178,15 +179,24 @@ void SampleShapeUI::draw( const MDrawRequest & request, M3dView & view ) const{
 			glGetFloatv( GL_POINT_SIZE, &oldPointSize );
 			glPointSize( 2.0 );
 
-			glBegin( GL_POINTS );
-
-			const MPointArray& samples = previewData->samples;
-			for( unsigned int i = 0; i < samples.length(); i++ ) {
-				glVertex3d( samples[ i ].x, samples[ i ].y, samples[ i ].z );
+			// the packed sample positions are drawn as a single vertex
+			// array. Decimation just widens the array stride, so changing
+			// it doesn't require to touch the data.
+			const std::vector< float >& positions = previewData->positions;
+			if ( !positions.empty() ) {
+				SampleShape* shape = (SampleShape*)surfaceShape();
+				int stride = MPlug( shape->thisMObject(), SampleShape::displayStride ).asInt();
+				if ( stride < 1 ) stride = 1;
+				const size_t numSamples = previewData->numSamples();
+				const size_t numDrawn = ( numSamples + stride - 1 ) / stride;
+
+				glPushClientAttrib( GL_CLIENT_VERTEX_ARRAY_BIT );
+				glEnableClientState( GL_VERTEX_ARRAY );
+				glVertexPointer( 3, GL_FLOAT, (GLsizei)( 3 * stride * sizeof( float ) ), &positions[ 0 ] );
+				glDrawArrays( GL_POINTS, 0, (GLsizei)numDrawn );
+				glPopClientAttrib();
 			}
 
-			glEnd();
-
 			glPointSize( oldPointSize );
 			view.endGL();
 			break;
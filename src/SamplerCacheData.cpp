@@ -31,9 +31,7 @@ SamplerCacheData::~SamplerCacheData() {
 void SamplerCacheData::copy(const MPxData& other) {
 	if (&other != this) {
 		const SamplerCacheData& _other = (const SamplerCacheData &)other;
-		triangleIds = _other.triangleIds;
-		triangleBarycentricCoords = _other.triangleBarycentricCoords;
-		randomNumbers = _other.randomNumbers;
+		cache = _other.cache;
 	}
 }
 
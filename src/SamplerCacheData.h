@@ -16,6 +16,8 @@ This software is released under the LGPL-3.0 license: http://www.opensource.org/
 #include <maya/MPointArray.h>
 #include <vector>
 
+#include "core/Sampling.h"
+
 /////////////////////////////////////////////////////////////////////
 //
 // class SamplerCacheData
@@ -50,13 +52,6 @@ public:
 	static const MString typeName;
 	static const MTypeId id;
 
-	struct triSampling_t {
-		int triangle;
-		float cdf;
-	};
-
-	std::vector< triSampling_t > triangleIds;
-	std::vector< std::pair<float, float> > triangleBarycentricCoords;
-	std::vector<float> randomNumbers;
+	samplerCache_t cache;
 };
 #endif // SamplerCacheData_h__
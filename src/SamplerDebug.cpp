@@ -22,6 +22,7 @@ This software is released under the LGPL-3.0 license: http://www.opensource.org/
 #include <maya/MFnCompoundAttribute.h>
 #include <maya/MFnVectorArrayData.h>
 #include <maya/MFnMatrixData.h>
+#include <maya/MPlugArray.h>
 
 #include "SamplerDebug.h"
 
@@ -35,6 +36,7 @@ const MString	SamplerDebug::typeName("SamplerDebug");
 MObject		SamplerDebug::inputSamples;
 MObject		SamplerDebug::inputPoints;
 MObject		SamplerDebug::inputNormals;
+MObject		SamplerDebug::displayStride;
 
 void *  SamplerDebug::creator()
 {
@@ -59,6 +61,7 @@ MStatus SamplerDebug::initialize()
 	//
 	MFnTypedAttribute	typedFn;
 	MFnCompoundAttribute cFn;
+	MFnNumericAttribute	nFn;
 	MStatus				stat;
 
 	inputPoints = typedFn.create("samplesPoints", "sp", MFnData::kPointArray);
@@ -75,32 +78,65 @@ MStatus SamplerDebug::initialize()
 	cFn.addChild(inputNormals);
 	cFn.setHidden(true);
 
+	displayStride = nFn.create("displayStride", "dst", MFnNumericData::kInt, 1);
+	nFn.setWritable(true);
+	nFn.setStorable(true);
+	nFn.setMin(1);
+	nFn.setSoftMax(100);
+
 	// Add the attributes we have created to the node
 	//
 	stat = addAttribute(inputSamples);
 	if (!stat) { stat.perror("addAttribute"); return stat; }
+	stat = addAttribute(displayStride);
+	if (!stat) { stat.perror("addAttribute"); return stat; }
 	
 	return MS::kSuccess;
 
 }
 
+MStatus SamplerDebug::setDependentsDirty( const MPlug& plug, MPlugArray& plugArray )
+{
+	if ( plug == inputPoints || plug == inputSamples ) {
+		m_positionsDirty = true;
+	}
+	return MPxLocatorNode::setDependentsDirty( plug, plugArray );
+}
+
 void SamplerDebug::draw(M3dView &view, const MDagPath &path, M3dView::DisplayStyle style, M3dView::DisplayStatus)
 {
 	MObject thisNode = thisMObject();
-	MPlug p = MPlug(thisNode, inputPoints);
-	MObject cvObject;
-	MStatus stat;
-	stat = p.getValue(cvObject);
+	if ( m_positionsDirty ) {
+		MPlug p = MPlug(thisNode, inputPoints);
+		MObject cvObject;
+		MStatus stat;
+		stat = p.getValue(cvObject);
+
+		MFnPointArrayData pointVecData(cvObject);
+		MPointArray pointVec = pointVecData.array();
+
+		m_positions.resize( 3 * pointVec.length() );
+		for (unsigned int i = 0; i < pointVec.length(); ++i)
+		{
+			m_positions[ 3 * i ] = (float)pointVec[i].x;
+			m_positions[ 3 * i + 1 ] = (float)pointVec[i].y;
+			m_positions[ 3 * i + 2 ] = (float)pointVec[i].z;
+		}
+		m_positionsDirty = false;
+	}
+	if ( m_positions.empty() ) {
+		return;
+	}
 
-	MFnPointArrayData pointVecData(cvObject);
-	MPointArray pointVec = pointVecData.array();
+	int stride = MPlug(thisNode, displayStride).asInt();
+	if ( stride < 1 ) stride = 1;
+	const size_t numPoints = m_positions.size() / 3;
 
 	view.beginGL();
-	glBegin(GL_POINTS);
-	for (unsigned int i = 0; i < pointVec.length(); ++i)
-	{
-		glVertex3f((float)pointVec[i].x, (float)pointVec[i].y, (float)pointVec[i].z);
-	}
-	glEnd();
+	glPushClientAttrib( GL_CLIENT_VERTEX_ARRAY_BIT );
+	glEnableClientState( GL_VERTEX_ARRAY );
+	glVertexPointer( 3, GL_FLOAT, (GLsizei)( 3 * stride * sizeof( float ) ), &m_positions[ 0 ] );
+	glDrawArrays( GL_POINTS, 0, (GLsizei)( ( numPoints + stride - 1 ) / stride ) );
+	glPopClientAttrib();
 	view.endGL();
 }
@@ -9,6 +9,7 @@ This software is released under the LGPL-3.0 license: http://www.opensource.org/
 
 #include <maya/MPxLocatorNode.h>
 #include <maya/MPointArray.h>
+#include <vector>
 
 /////////////////////////////////////////////////////////////////////
 //
@@ -22,7 +23,7 @@ This software is released under the LGPL-3.0 license: http://www.opensource.org/
 class SamplerDebug : public MPxLocatorNode
 {
 public:
-	SamplerDebug() {}
+	SamplerDebug() : m_positionsDirty( true ) {}
 	virtual ~SamplerDebug() {}
 
 	/////////////////////////////////////////////////////////////////////
@@ -34,6 +35,7 @@ public:
 	
 	virtual void draw(M3dView &view, const MDagPath &path, M3dView::DisplayStyle style, M3dView::DisplayStatus);
 	virtual bool isBounded() const { return false; }
+	virtual MStatus setDependentsDirty( const MPlug& plug, MPlugArray& plugArray );
 
 	static  void *      creator();
 	static  MStatus			initialize();
@@ -41,6 +43,7 @@ public:
 	static	MObject		inputSamples;	// input vector array
 	static	MObject		inputPoints;
 	static	MObject		inputNormals;
+	static	MObject		displayStride;	// only every n-th sample is drawn
 
 	// The typeid is a unique 32bit identifier that describes this node.
 	// It is used to save and retrieve nodes of this type from the binary
@@ -48,4 +51,10 @@ public:
 	//
 	static const MTypeId	id;
 	static const MString	typeName;
+
+private:
+	// input points packed as 3 floats each, only fetched again from the
+	// plug after it gets dirty
+	std::vector< float >	m_positions;
+	bool					m_positionsDirty;
 };
@@ -7,12 +7,17 @@
 
 #include "SamplerNode.h"
 #include "SamplerCacheData.h"
+#include "SampleData.h"
+#include "MayaTaskRunner.h"
+#include "GrowerStats.h"
+#include "core/Sampling.h"
 
 #include <maya/MPlug.h>
 #include <maya/MDataBlock.h>
 #include <maya/MDataHandle.h>
 #include <maya/MFnNumericAttribute.h>
 #include <maya/MFnTypedAttribute.h>
+#include <maya/MFnEnumAttribute.h>
 #include <maya/MVectorArray.h>
 #include <maya/MFnPointArrayData.h>
 #include <maya/MFnVectorArrayData.h>
@@ -32,7 +37,6 @@
 #include <maya/MFnPluginData.h>
 
 #include <vector>
-#include <algorithm>
 
 //////////////////////////////////////////////////////////////////////
 //
@@ -62,14 +66,21 @@ MTypeId     Sampler::id( 0x80099 );
 // Attributes
 MObject		Sampler::cachePlacement;
 MObject		Sampler::nSamples;
+MObject		Sampler::seed;
+MObject		Sampler::distribution;
 MObject     Sampler::inputMesh;        
 MObject		Sampler::useVertexCol;
 MObject		Sampler::colorSet;
 MObject     Sampler::outputSamples;
 MObject		Sampler::outputPoints;
 MObject		Sampler::outputNormals;
+MObject		Sampler::outputSampleData;
 MObject		Sampler::worldToLocal;
 MObject		Sampler::samplerCache;
+MObject		Sampler::statComputeTime;
+MObject		Sampler::statSampleTime;
+MObject		Sampler::statIndexTime;
+MObject		Sampler::statBytes;
 
 Sampler::Sampler() {}
 Sampler::~Sampler() {}
@@ -91,7 +102,7 @@ MStatus Sampler::compute( const MPlug& plug, MDataBlock& data )
 	// node doesn't know how to compute it, we must return 
 	// MS::kUnknownParameter.
 	// 
-	if( plug == outputSamples ) {
+	if( plug == outputSampleData ) {
 		MStatus stat;
 		// Get a handle to the input attribute that we will need for the
 		// computation.  If the value is being supplied via a connection 
@@ -103,6 +114,7 @@ MStatus Sampler::compute( const MPlug& plug, MDataBlock& data )
 		int numSamples = data.inputValue( nSamples, &returnStatus ).asInt();
 		if ( returnStatus != MS::kSuccess ) return MStatus::kInvalidParameter;
 
+		StatTimer computeTimer( "compute", thisMObject() );
 
 		MFnPluginData fnDataCreator;
 		MTypeId tmpid(SamplerCacheData::id);
@@ -121,14 +133,21 @@ MStatus Sampler::compute( const MPlug& plug, MDataBlock& data )
 		}
 
 		const bool doCachePlacement = data.inputValue(cachePlacement, &returnStatus).asBool();
+		const int randomSeed = data.inputValue(seed, &returnStatus).asInt();
+		const int sampleDistribution = data.inputValue(distribution, &returnStatus).asShort();
 		
+		MDataHandle sampleDataHandle = data.outputValue( outputSampleData );
+		SampleData* sampleData = (SampleData*)sampleDataHandle.asPluginData();
+		if ( sampleData == NULL ) {
+			MFnPluginData fnSampleDataCreator;
+			fnSampleDataCreator.create( SampleData::id, &stat );
+			MCHECKERROR(stat, "compute : error creating SampleData")
+			sampleData = (SampleData*)fnSampleDataCreator.data( &stat );
+			MCHECKERROR(stat, "compute : error gettin at proxy SampleData object")
+		}
+
 		MFnMesh mesh( inputMeshHandle.asMesh() );
 		{					
-			MDataHandle outputHandle = data.outputValue( Sampler::outputSamples );
-			MFnPointArrayData pointsHandle( outputHandle.child( Sampler::outputPoints ).data() );
-			MPointArray points = pointsHandle.array();
-			MFnVectorArrayData normalsHandle( outputHandle.child( Sampler::outputNormals ).data() );
-			MVectorArray normals = normalsHandle.array();
 			bool useVertexColor = data.inputValue( Sampler::useVertexCol ).asBool();
 			MString colorSet = data.inputValue( Sampler::colorSet ).asString();
 						
@@ -152,7 +171,14 @@ MStatus Sampler::compute( const MPlug& plug, MDataBlock& data )
 				world2LocalHandle.set( matrixDataObject );	
 			}
 		
-			SampleMesh(mesh, numSamples, useVertexColor, colorSet, doCachePlacement, newData, points, normals);
+			StatTimer sampleTimer( "sampleMesh", thisMObject() );
+			SampleMesh(mesh, numSamples, randomSeed, sampleDistribution, useVertexColor, colorSet, doCachePlacement, newData, sampleData->samples);
+			SetStat( data, statSampleTime, sampleTimer.Stop() );
+
+			// the kd-tree is only built again if the samples moved
+			StatTimer indexTimer( "kdTreeBuild", thisMObject() );
+			sampleData->samples.Update( true );
+			SetStat( data, statIndexTime, indexTimer.Stop() );
 
 			// Assign the new data to the outputSurface handle
 
@@ -160,6 +186,13 @@ MStatus Sampler::compute( const MPlug& plug, MDataBlock& data )
 			{
 				samplerCacheHandle.set(newData);
 			}
+			if (sampleData != sampleDataHandle.asPluginData()) 
+			{
+				sampleDataHandle.set(sampleData);
+			}
+
+			SetStat( data, statBytes, (double)( sampleData->samples.Bytes() + newData->cache.Bytes() ) );
+			SetStat( data, statComputeTime, computeTimer.Stop() );
 
 			// Mark the destination plug as being clean.  This will prevent the
 			// dependency graph from repeating this calculation until an input 
@@ -167,6 +200,28 @@ MStatus Sampler::compute( const MPlug& plug, MDataBlock& data )
 			// 
 			data.setClean(plug);
 		}
+	} else if ( plug == outputSamples ) {
+		// the point and vector arrays are only filled for the nodes still 
+		// reading them, out of the sample data
+		const SampleData* sampleData = (const SampleData*)data.inputValue( outputSampleData, &returnStatus ).asPluginData();
+		if ( returnStatus != MS::kSuccess || sampleData == NULL ) return MS::kFailure;
+		const samplePoints_t& samples = sampleData->samples;
+
+		MPointArray points( (unsigned int)samples.Size() );
+		MVectorArray normals( (unsigned int)samples.Size() );
+		for ( unsigned int i = 0; i < points.length(); i++ ) {
+			const vec3_t p = samples.Pos( i );
+			const vec3_t n = samples.Normal( i );
+			points[ i ] = MPoint( p.x, p.y, p.z );
+			normals[ i ] = MVector( n.x, n.y, n.z );
+		}
+
+		MDataHandle outputHandle = data.outputValue( Sampler::outputSamples );
+		MFnPointArrayData pointsData;
+		outputHandle.child( Sampler::outputPoints ).set( pointsData.create( points ) );
+		MFnVectorArrayData normalsData;
+		outputHandle.child( Sampler::outputNormals ).set( normalsData.create( normals ) );
+		data.setClean(plug);
 	} else {
 		return MS::kUnknownParameter;
 	}
@@ -174,149 +229,57 @@ MStatus Sampler::compute( const MPlug& plug, MDataBlock& data )
 	return MS::kSuccess;
 }
 
+//////////////////////////////////////////////////////////////////////////
+// Sampler::SampleMesh
+//
+//	Feeds the mesh arrays to the sampling in the core library.
+//////////////////////////////////////////////////////////////////////////
+
 void Sampler::SampleMesh(MFnMesh& mesh,
 	int numSamples,
+	int randomSeed,
+	int sampleDistribution,
 	bool useVertexColor,
 	const MString& colorSetName,
 	bool doCachePlacement,
 	SamplerCacheData* samplerCacheData,
-	MPointArray& points,
-	MVectorArray& normals) {
-	points.clear();
-	normals.clear();
-
-	MColorArray vertexColors;
-	if (useVertexColor) {
-		mesh.getVertexColors(vertexColors, &colorSetName);
-	}
+	samplePoints_t& samples) {
 
 	MIntArray triangleCounts, triangleVertices;
 	mesh.getTriangles(triangleCounts, triangleVertices);
-	unsigned int numTriangles = triangleVertices.length() / 3;
 
 	MFloatVectorArray vNormals;
 	mesh.getVertexNormals(true, vNormals);
-
-	MPointArray verts;
-	mesh.getPoints(verts, MSpace::kWorld);
-
-	std::vector< SamplerCacheData::triSampling_t >* pTriangleId = NULL;
-	std::vector< std::pair<float, float> >* pBarycentricCoord = NULL;
-	std::vector<float>* pRNG = NULL;
-
-	bool useSampleCache = doCachePlacement && 
-						  samplerCacheData->randomNumbers.size() == numSamples &&
-						  samplerCacheData->triangleIds.size() == numTriangles;
-	
-	if (useSampleCache)
-	{
-		pTriangleId = &samplerCacheData->triangleIds;
-		pBarycentricCoord = &samplerCacheData->triangleBarycentricCoords;
-		pRNG = &samplerCacheData->randomNumbers;
+	std::vector< float > normals( 3 * vNormals.length() );
+	for (unsigned int i = 0; i < vNormals.length(); i++) {
+		normals[3 * i + 0] = vNormals[i].x;
+		normals[3 * i + 1] = vNormals[i].y;
+		normals[3 * i + 2] = vNormals[i].z;
 	}
-	else
-	{
-		// recompute sample placement
 
-		pTriangleId = &samplerCacheData->triangleIds;
-		pBarycentricCoord = &samplerCacheData->triangleBarycentricCoords;
-		pRNG = &samplerCacheData->randomNumbers;
-	
-		(*pTriangleId).resize(numTriangles);
-		(*pBarycentricCoord).resize(numSamples);
-		memset(&(*pBarycentricCoord)[0], 0, numSamples * sizeof(std::pair<float, float>));
-
-		pRNG->resize(numSamples);
-		for (int i = 0; i < numSamples; ++i)
-		{
-			(*pRNG)[i] = (float)rand() / RAND_MAX;
-		}
-
-		for (unsigned int i = 0; i < numTriangles; i++) {
-			const int iA = triangleVertices[3 * i + 0];
-			const int iB = triangleVertices[3 * i + 1];
-			const int iC = triangleVertices[3 * i + 2];
-			const MVector AB = verts[iB] - verts[iA];
-			const MVector AC = verts[iC] - verts[iA];
-			const float area = 0.5f * (float)(AB ^ AC).length();
-
-			float importance = area;
-			if (useVertexColor && vertexColors.length() > 0) {
-				MColor triCol = vertexColors[iA] + vertexColors[iB] + vertexColors[iC];
-				const float third = 1.0f / 3.0f;
-				triCol.r *= third;
-				triCol.g *= third;
-				triCol.b *= third;
-				const float lightness = std::min(1.0f, std::max(0.f, (triCol.r + triCol.g + triCol.b) * third));
-				importance *= lightness;
-			}
-
-			(*pTriangleId)[i].triangle = i;
-			(*pTriangleId)[i].cdf = importance; // not a cdf yet
-		}
-
-		if (numTriangles == 0) {
-			if (samplerCacheData == NULL)
-			{
-				delete pTriangleId;
-				delete pBarycentricCoord;
-				delete pRNG;
-			}
-			return;
-		}
-
-		// cumulative probability distribution for faces
-		float cdf = 0.f;
-		for (size_t i = 0; i < numTriangles; ++i)
-		{
-			cdf +=  (*pTriangleId)[i].cdf;
-			(*pTriangleId)[i].cdf = cdf;
+	std::vector< float > colors;
+	if (useVertexColor) {
+		MColorArray vertexColors;
+		mesh.getVertexColors(vertexColors, &colorSetName);
+		colors.resize( 3 * vertexColors.length() );
+		for (unsigned int i = 0; i < vertexColors.length(); i++) {
+			colors[3 * i + 0] = vertexColors[i].r;
+			colors[3 * i + 1] = vertexColors[i].g;
+			colors[3 * i + 2] = vertexColors[i].b;
 		}
 	}
 
-
-	// Sample triangles
-	const float maxTriangleCDF = (*pTriangleId)[(*pTriangleId).size()-1].cdf;
-	for (int i = 0; i < numSamples; i++) {
-		float r = (*pRNG)[i] * maxTriangleCDF; // non-normalised CDF
-		int triId = 0;
-		while(triId < (*pTriangleId).size() && (*pTriangleId)[triId].cdf < r )
-		{
-			triId++;
-		}
-
-		// sample using barycentric coordinates
-		float u, v;
-		if (useSampleCache)
-		{
-			u = (*pBarycentricCoord)[i].first;
-			v = (*pBarycentricCoord)[i].second;
-		}
-		else
-		{
-			do {
-				u = (float)rand() / RAND_MAX;
-				v = (float)rand() / RAND_MAX;
-			} while (u + v > 1);
-			if (pBarycentricCoord != NULL)
-			{
-				(*pBarycentricCoord)[i] = std::pair<float, float>(u, v);
-			}
-		}
-		const int iA = triangleVertices[3 * triId + 0];
-		const int iB = triangleVertices[3 * triId + 1];
-		const int iC = triangleVertices[3 * triId + 2];
-		const MPoint A = verts[iA];
-		const MPoint B = verts[iB];
-		const MPoint C = verts[iC];
-	
-		const float w = 1.0f - u - v;
-		points.append(A * w + B * u + C * v);
-	
-		MVector n = vNormals[iA] * w + vNormals[iB] * u + vNormals[iC] * v;
-		n.normalize();
-		normals.append(n);
-	}
+	MStatus stat;
+	triangleMesh_t triMesh;
+	triMesh.positions		= mesh.getRawPoints( &stat );
+	triMesh.normals			= normals.empty() ? NULL : &normals[0];
+	triMesh.colors			= colors.empty() ? NULL : &colors[0];
+	triMesh.triangles		= triangleVertices.length() > 0 ? &triangleVertices[0] : NULL;
+	triMesh.numVertices		= (size_t)mesh.numVertices();
+	triMesh.numTriangles	= stat ? triangleVertices.length() / 3 : 0;
+
+	MayaTaskRunner runner;
+	::SampleMesh(triMesh, numSamples, randomSeed, sampleDistribution, doCachePlacement, samplerCacheData->cache, samples, runner);
 }
 
 void* Sampler::creator()
@@ -350,6 +313,7 @@ MStatus Sampler::initialize()
 	MFnTypedAttribute	tAttr;
 	MFnNumericAttribute nAttr;
 	MFnCompoundAttribute cAttr;
+	MFnEnumAttribute	eAttr;
 	MStatus				stat;
 
 	cachePlacement = nAttr.create("cachePlacement", "cp", MFnNumericData::kBoolean, true, &stat);
@@ -363,6 +327,19 @@ MStatus Sampler::initialize()
 	nAttr.setWritable( true );
 	nAttr.setStorable( true );
 
+	seed = nAttr.create( "seed", "sd", MFnNumericData::kInt, 0, &stat );
+	if ( !stat ) return stat;
+	nAttr.setMin( 0 );
+	nAttr.setWritable( true );
+	nAttr.setStorable( true );
+
+	distribution = eAttr.create( "distribution", "dst", SD_RANDOM, &stat );
+	if ( !stat ) return stat;
+	eAttr.addField( "random", SD_RANDOM );
+	eAttr.addField( "poissonDisk", SD_POISSON_DISK );
+	eAttr.setWritable( true );
+	eAttr.setStorable( true );
+
 	
 	inputMesh = tAttr.create( "inputMesh", "m", MFnData::kMesh, MObject::kNullObj, &stat );
 	if ( !stat ) return stat;
@@ -401,6 +378,12 @@ MStatus Sampler::initialize()
 	tAttr.setStorable(false);
 	//tAttr.setHidden( true );
 
+	outputSampleData = tAttr.create( "outSampleData", "osd", SampleData::id, MObject::kNullObj, &stat );
+	if ( !stat ) return stat;
+	tAttr.setWritable( false );
+	tAttr.setStorable( false );
+	tAttr.setHidden( true );
+
 	outputSamples = cAttr.create( "outSamples", "os", &stat );
 	if ( !stat ) return stat;
 
@@ -420,6 +403,15 @@ MStatus Sampler::initialize()
 	tAttr.setStorable(true);
 	tAttr.setHidden(true);
 
+	statComputeTime = CreateStatAttribute( "statComputeTime", "sct", stat );
+	if ( !stat ) return stat;
+	statSampleTime = CreateStatAttribute( "statSampleTime", "sst", stat );
+	if ( !stat ) return stat;
+	statIndexTime = CreateStatAttribute( "statIndexTime", "sxt", stat );
+	if ( !stat ) return stat;
+	statBytes = CreateStatAttribute( "statBytes", "sby", stat );
+	if ( !stat ) return stat;
+
 	// Add the attributes we have created to the node
 	//
 
@@ -427,6 +419,10 @@ MStatus Sampler::initialize()
 	if (!stat) { stat.perror("addAttribute"); return stat; }
 	stat = addAttribute(nSamples);
 	if (!stat) { stat.perror("addAttribute"); return stat;}
+	stat = addAttribute(seed);
+	if (!stat) { stat.perror("addAttribute"); return stat;}
+	stat = addAttribute(distribution);
+	if (!stat) { stat.perror("addAttribute"); return stat;}
 	stat = addAttribute( inputMesh );
 	if (!stat) { stat.perror("addAttribute"); return stat;}
 	stat = addAttribute( useVertexCol );
@@ -435,10 +431,20 @@ MStatus Sampler::initialize()
 	if (!stat) { stat.perror("addAttribute"); return stat;}
 	stat = addAttribute( outputSamples );
 	if (!stat) { stat.perror("addAttribute"); return stat;}
+	stat = addAttribute( outputSampleData );
+	if (!stat) { stat.perror("addAttribute"); return stat;}
 	stat = addAttribute( worldToLocal );
 	if (!stat) { stat.perror("addAttribute"); return stat;}
 	stat = addAttribute(samplerCache);
 	if (!stat) { stat.perror("addAttribute"); return stat; }
+	stat = addAttribute( statComputeTime );
+	if (!stat) { stat.perror("addAttribute"); return stat;}
+	stat = addAttribute( statSampleTime );
+	if (!stat) { stat.perror("addAttribute"); return stat;}
+	stat = addAttribute( statIndexTime );
+	if (!stat) { stat.perror("addAttribute"); return stat;}
+	stat = addAttribute( statBytes );
+	if (!stat) { stat.perror("addAttribute"); return stat;}
 
 	// Set up a dependency between the input and the output.  This will cause
 	// the output to be marked dirty when the input changes.  The output will
@@ -446,12 +452,28 @@ MStatus Sampler::initialize()
 	//
 	stat = attributeAffects( nSamples, outputSamples );
 	if (!stat) { stat.perror("attributeAffects"); return stat;}
+	stat = attributeAffects( nSamples, outputSampleData );
+	if (!stat) { stat.perror("attributeAffects"); return stat;}
+	stat = attributeAffects( seed, outputSamples );
+	if (!stat) { stat.perror("attributeAffects"); return stat;}
+	stat = attributeAffects( seed, outputSampleData );
+	if (!stat) { stat.perror("attributeAffects"); return stat;}
+	stat = attributeAffects( distribution, outputSamples );
+	if (!stat) { stat.perror("attributeAffects"); return stat;}
+	stat = attributeAffects( distribution, outputSampleData );
+	if (!stat) { stat.perror("attributeAffects"); return stat;}
 	stat = attributeAffects( useVertexCol, outputSamples );
 	if (!stat) { stat.perror("attributeAffects"); return stat;}
+	stat = attributeAffects( useVertexCol, outputSampleData );
+	if (!stat) { stat.perror("attributeAffects"); return stat;}
 	stat = attributeAffects( colorSet, outputSamples );
 	if (!stat) { stat.perror("attributeAffects"); return stat;}
+	stat = attributeAffects( colorSet, outputSampleData );
+	if (!stat) { stat.perror("attributeAffects"); return stat;}
 	stat = attributeAffects( inputMesh, outputSamples );
 	if (!stat) { stat.perror("attributeAffects"); return stat;}
+	stat = attributeAffects( inputMesh, outputSampleData );
+	if (!stat) { stat.perror("attributeAffects"); return stat;}
 	stat = attributeAffects( inputMesh, worldToLocal );
 	if (!stat) { stat.perror("attributeAffects"); return stat;}
 
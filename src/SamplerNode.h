@@ -15,6 +15,7 @@
 #include <maya/MVectorArray.h>
 
 class SamplerCacheData;
+struct samplePoints_t;
 
 class Sampler : public MPxNode
 {
@@ -35,16 +36,25 @@ public:
 	//
 	static  MObject		cachePlacement; // whether to stick samples to surface by caching previously generated solution until topology changes.
 	static  MObject		nSamples;		// number of desired samples
+	static  MObject		seed;			// random seed, samples are the same for a given seed on every machine
+	static  MObject		distribution;	// sampleDistribution_e
 	static	MObject		inputMesh;		// input mesh to sample
 	static	MObject		useVertexCol;	// use vertex color to determine where to sample
 	static	MObject		colorSet;
 	static  MObject		outputSamples;	// output samples array
 	static	MObject		outputPoints;	// child of outputSamples
 	static	MObject		outputNormals;	// child of outputSamples
+	static	MObject		outputSampleData;	// SampleData, the samples along with their kd-tree
 	static	MObject		worldToLocal;	// output copy of mesh transform
 
 	static  MObject		samplerCache;	// SamplerCacheData
 
+	// counters of the last evaluation, read-only (see GrowerStats.h)
+	static	MObject		statComputeTime;
+	static	MObject		statSampleTime;	// placing the samples over the mesh
+	static	MObject		statIndexTime;	// building the kd-tree
+	static	MObject		statBytes;		// held by the samples, their kd-tree and the placement cache
+
 	// The typeid is a unique 32bit identifier that describes this node.
 	// It is used to save and retrieve nodes of this type from the binary
 	// file format.  If it is not unique, it will cause file IO problems.
@@ -54,12 +64,13 @@ public:
 private:
 	void SampleMesh( MFnMesh& mesh, 
 					 int numSamples, 
+					 int randomSeed,
+					 int sampleDistribution,
 					 bool vertexColor, 
 					 const MString& colorSetName, 
 					 bool doCachePlacement,
 					 SamplerCacheData* samplerCacheData,
-					 MPointArray& points,
-					 MVectorArray& normals );
+					 samplePoints_t& samples );
 };
 
 #endif
@@ -7,6 +7,8 @@
 
 #include "TrimmerNode.h"
 #include "GrowerData.h"
+#include "GrowerStats.h"
+#include "core/Trimming.h"
 
 #include <maya/MFnTypedAttribute.h>
 #include <maya/MFnNumericAttribute.h>
@@ -20,6 +22,7 @@ MTypeId     Trimmer::id( 0x80096 );
 MObject		Trimmer::maxLength;
 MObject     Trimmer::inputData;        
 MObject     Trimmer::outputData;
+MObject		Trimmer::statComputeTime;
 
 Trimmer::Trimmer() {}
 Trimmer::~Trimmer() {}
@@ -59,12 +62,14 @@ MStatus Trimmer::compute( const MPlug& plug, MDataBlock& data )
 			return MS::kFailure;
 		}
 
+		StatTimer computeTimer( "compute", thisMObject() );
 		int maxDepth = GetMaxDepth( growerData->nodes );
 		int length = (int)ceilf( (float)maxDepth * data.inputValue( Trimmer::maxLength ).asFloat() ) + 1;
 
 		Trim( growerData->nodes, length );
 
 		outDataHandle.setMPxData( growerData );
+		SetStat( data, statComputeTime, computeTimer.Stop() );
 		data.setClean( plug );
 		return MS::kSuccess;
 	}
@@ -72,53 +77,6 @@ MStatus Trimmer::compute( const MPlug& plug, MDataBlock& data )
 	return MS::kUnknownParameter;
 }
 
-int Trimmer::GetMaxDepth( const std::vector< growerNode_t >& nodes ) const {
-	int depth = 0;
-	std::vector< size_t > nodeList[ 2 ];
-	nodeList[ 0 ].push_back( 0 );
-	while( !nodeList[ depth % 2 ].empty() ) {
-		std::vector< size_t >& activeNodes = nodeList[ depth % 2 ];
-		std::vector< size_t >& activeChildren = nodeList[ ( depth % 2 ) ^ 1 ];
-
-		activeChildren.resize( 0 );
-		for( size_t i = 0; i < activeNodes.size(); i++ ) {
-			const growerNode_t& node = nodes[ activeNodes[ i ] ];
-			for( size_t j = 0; j < node.children.size(); j++ ) {
-				activeChildren.push_back( node.children[ j ] );
-			}
-		}
-
-		depth ++;		
-	}
-	return depth;
-}
-
-void Trimmer::Trim( std::vector< growerNode_t >& nodes, const int maxLength ) {
-	size_t depth = 0;
-	std::vector< size_t > nodeList[ 2 ];
-	nodeList[ 0 ].push_back( 0 );
-	while( !nodeList[ depth % 2 ].empty() ) {
-		std::vector< size_t >& activeNodes = nodeList[ depth % 2 ];
-		std::vector< size_t >& activeChildren = nodeList[ ( depth % 2 ) ^ 1 ];
-
-		activeChildren.resize( 0 );
-		for( size_t i = 0; i < activeNodes.size(); i++ ) {
-			growerNode_t& node = nodes[ activeNodes[ i ] ];
-			node.trimmed = ( depth == maxLength );
-			for( size_t j = 0; j < node.children.size(); j++ ) {
-				activeChildren.push_back( node.children[ j ] );
-			}
-		}
-
-		depth ++;
-		if ( depth > (size_t)maxLength ) {
-			// don't keep going deeper, the current active nodes have been marked as trimmed
-			// and will stop the meshing
-			break;
-		}
-	}
-}
-
 void* Trimmer::creator()
 //
 //	Description:
@@ -171,6 +129,9 @@ MStatus Trimmer::initialize()
 	tAttr.setReadable( true );
 	tAttr.setStorable(false);
 
+	statComputeTime = CreateStatAttribute( "statComputeTime", "sct", stat );
+	if ( !stat ) return stat;
+
 	// Add the attributes we have created to the node
 	//
 	stat = addAttribute( maxLength );
@@ -179,6 +140,8 @@ MStatus Trimmer::initialize()
 	if (!stat) { stat.perror("addAttribute"); return stat;}
 	stat = addAttribute( outputData );
 	if (!stat) { stat.perror("addAttribute"); return stat;}
+	stat = addAttribute( statComputeTime );
+	if (!stat) { stat.perror("addAttribute"); return stat;}
 
 	// Set up a dependency between the input and the output.  This will cause
 	// the output to be marked dirty when the input changes.  The output will
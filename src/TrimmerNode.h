@@ -13,8 +13,6 @@
 #include <maya/MTypeId.h> 
 #include <vector>
 
-struct growerNode_t;
-
 class Trimmer : public MPxNode
 {
 public:
@@ -38,15 +36,14 @@ public:
 	static	MObject		inputData;		// GrowerData
 	static	MObject		outputData;		// GrowerData
 
+	// counters of the last evaluation, read-only (see GrowerStats.h)
+	static	MObject		statComputeTime;
+
 	// The typeid is a unique 32bit identifier that describes this node.
 	// It is used to save and retrieve nodes of this type from the binary
 	// file format.  If it is not unique, it will cause file IO problems.
 	//
 	static	MTypeId		id;
-
-private:
-	int GetMaxDepth( const std::vector< growerNode_t >& nodes ) const;
-	void Trim( std::vector< growerNode_t >& nodes, const int maxLength );
 };
 
 
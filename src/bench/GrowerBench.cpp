@@ -0,0 +1,694 @@
+/* 
+	================================================================================
+	Copyright (c) 2012, Jose Esteve. http://www.joesfer.com
+	This software is released under the LGPL-3.0 license: http://www.opensource.org/licenses/lgpl-3.0.html	
+	================================================================================
+*/
+
+//////////////////////////////////////////////////////////////////////////
+//
+// GrowerBench
+//
+//	Times each stage of the Grower pipeline on synthetic meshes, outside
+//	of Maya: mesh sampling, the kd-tree build over the samples, growth,
+//	trimming, thickness and tube meshing. The inputs are generated from
+//	fixed seeds, so runs are comparable across builds and machines. The
+//	results are written as JSON.
+//
+//	usage: GrowerBench [--meshes sphere,torus,scan]
+//	                   [--samples 10000,100000,1000000,5000000]
+//	                   [--distribution random|poisson]
+//	                   [--repeat 3] [--output results.json]
+//	       GrowerBench --check
+//
+//	Every stage runs --repeat times on the same input and reports the
+//	fastest and the mean time. Tasks run serially on the calling thread
+//	through the base TaskRunner, so the numbers measure the algorithms
+//	rather than the host's thread pool.
+//
+//	--check runs the pipeline once through the base TaskRunner and once
+//	through a runner splitting the work into many tasks, and fails if
+//	the outputs differ in any bit (see CheckDeterminism). It also checks
+//	the growth log replays the same nodes and stays smaller than copying
+//	the closest node array on every iteration. ctest runs it.
+//
+//////////////////////////////////////////////////////////////////////////
+
+#include "../core/Sampling.h"
+#include "../core/Colonization.h"
+#include "../core/Trimming.h"
+#include "../core/Thickness.h"
+#include "../core/TubeMesh.h"
+#include "../core/Random.h"
+#include "../core/Profiler.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+
+// Node attribute defaults (see Grower::initialize, GrowerShape::initialize)
+#define BENCH_SEARCH_RADIUS		0.5f	// relative to the sample bounds
+#define BENCH_KILL_RADIUS		0.01f
+#define BENCH_GROW_DIST			0.01f
+#define BENCH_MAX_NEIGHBORS		10
+#define BENCH_TUBE_SECTIONS		8
+#define BENCH_THICKNESS_SCALE	1.0f
+#define BENCH_TRIM_LENGTH		0.75f	// fraction of the hierarchy depth kept by the trim stage
+
+//////////////////////////////////////////////////////////////////////////
+//
+// Synthetic meshes
+//
+//////////////////////////////////////////////////////////////////////////
+
+struct benchMesh_t {
+	std::string				name;
+	std::vector< float >	positions;
+	std::vector< float >	normals;
+	std::vector< int >		triangles;
+
+	size_t NumVertices() const { return positions.size() / 3; }
+	size_t NumTriangles() const { return triangles.size() / 3; }
+};
+
+// Triangulates a (columns + 1) x (rows + 1) vertex grid, row by row
+static void GridTriangles( int columns, int rows, std::vector< int >& triangles ) {
+	triangles.resize( 0 );
+	triangles.reserve( 6 * columns * rows );
+	for( int j = 0; j < rows; j++ ) {
+		for( int i = 0; i < columns; i++ ) {
+			const int a = j * ( columns + 1 ) + i;
+			const int b = a + 1;
+			const int c = a + columns + 1;
+			const int d = c + 1;
+			triangles.push_back( a ); triangles.push_back( c ); triangles.push_back( b );
+			triangles.push_back( b ); triangles.push_back( c ); triangles.push_back( d );
+		}
+	}
+}
+
+// Area weighted vertex normals
+static void ComputeNormals( benchMesh_t& mesh ) {
+	const size_t numVertices = mesh.NumVertices();
+	std::vector< vec3_t > accum( numVertices );
+	for( size_t i = 0; i < mesh.NumTriangles(); i++ ) {
+		const int* tri = &mesh.triangles[ 3 * i ];
+		const vec3_t a( &mesh.positions[ 3 * tri[ 0 ] ] );
+		const vec3_t b( &mesh.positions[ 3 * tri[ 1 ] ] );
+		const vec3_t c( &mesh.positions[ 3 * tri[ 2 ] ] );
+		const vec3_t n = ( b - a ) ^ ( c - a );
+		for( int k = 0; k < 3; k++ ) {
+			accum[ tri[ k ] ] += n;
+		}
+	}
+	mesh.normals.resize( 3 * numVertices );
+	for( size_t i = 0; i < numVertices; i++ ) {
+		accum[ i ].normalize();
+		accum[ i ].get( &mesh.normals[ 3 * i ] );
+	}
+}
+
+static void MakeSphere( int segments, int rings, benchMesh_t& mesh ) {
+	mesh.name = "sphere";
+	mesh.positions.resize( 0 );
+	for( int j = 0; j <= rings; j++ ) {
+		const double theta = 3.14159265358979 * j / rings;
+		for( int i = 0; i <= segments; i++ ) {
+			const double phi = 2.0 * 3.14159265358979 * i / segments;
+			mesh.positions.push_back( (float)( sin( theta ) * cos( phi ) ) );
+			mesh.positions.push_back( (float)cos( theta ) );
+			mesh.positions.push_back( (float)( sin( theta ) * sin( phi ) ) );
+		}
+	}
+	GridTriangles( segments, rings, mesh.triangles );
+	ComputeNormals( mesh );
+}
+
+static void MakeTorus( int segments, int sides, float radius, float tubeRadius, benchMesh_t& mesh ) {
+	mesh.name = "torus";
+	mesh.positions.resize( 0 );
+	for( int j = 0; j <= sides; j++ ) {
+		const double theta = 2.0 * 3.14159265358979 * j / sides;
+		for( int i = 0; i <= segments; i++ ) {
+			const double phi = 2.0 * 3.14159265358979 * i / segments;
+			const double r = radius + tubeRadius * cos( theta );
+			mesh.positions.push_back( (float)( r * cos( phi ) ) );
+			mesh.positions.push_back( (float)( tubeRadius * sin( theta ) ) );
+			mesh.positions.push_back( (float)( r * sin( phi ) ) );
+		}
+	}
+	GridTriangles( segments, sides, mesh.triangles );
+	ComputeNormals( mesh );
+}
+
+// Smoothly interpolated lattice noise in [0, 1)
+static float ValueNoise( unsigned int seed, float x, float y ) {
+	const int ix = (int)floorf( x );
+	const int iy = (int)floorf( y );
+	float fx = x - ix, fy = y - iy;
+	fx = fx * fx * ( 3 - 2 * fx );
+	fy = fy * fy * ( 3 - 2 * fy );
+	float v[ 4 ];
+	for( int k = 0; k < 4; k++ ) {
+		const unsigned int lx = (unsigned int)( ix + ( k & 1 ) );
+		const unsigned int ly = (unsigned int)( iy + ( k >> 1 ) );
+		v[ k ] = RandomFloat( seed, lx * 4099u + ly, 0 );
+	}
+	const float a = v[ 0 ] + ( v[ 1 ] - v[ 0 ] ) * fx;
+	const float b = v[ 2 ] + ( v[ 3 ] - v[ 2 ] ) * fx;
+	return a + ( b - a ) * fy;
+}
+
+// A terrain-like heightfield with fractal noise and jittered vertices,
+// standing in for a scanned surface: uneven triangle sizes and normals
+static void MakeScan( int resolution, benchMesh_t& mesh ) {
+	mesh.name = "scan";
+	mesh.positions.resize( 0 );
+	const unsigned int seed = 1;
+	const float cell = 2.0f / resolution;
+	for( int j = 0; j <= resolution; j++ ) {
+		for( int i = 0; i <= resolution; i++ ) {
+			const unsigned int vertex = (unsigned int)( j * ( resolution + 1 ) + i );
+			float x = -1.0f + i * cell;
+			float z = -1.0f + j * cell;
+			if ( i > 0 && i < resolution && j > 0 && j < resolution ) {
+				x += ( RandomFloat( seed, vertex, 1 ) - 0.5f ) * 0.5f * cell;
+				z += ( RandomFloat( seed, vertex, 2 ) - 0.5f ) * 0.5f * cell;
+			}
+			float height = 0, amplitude = 0.25f, frequency = 2.0f;
+			for( int octave = 0; octave < 6; octave++ ) {
+				height += amplitude * ( ValueNoise( seed + octave, ( x + 1 ) * frequency, ( z + 1 ) * frequency ) - 0.5f );
+				amplitude *= 0.5f;
+				frequency *= 2.0f;
+			}
+			height += ( RandomFloat( seed, vertex, 3 ) - 0.5f ) * 0.002f; // scanner noise
+			mesh.positions.push_back( x );
+			mesh.positions.push_back( height );
+			mesh.positions.push_back( z );
+		}
+	}
+	GridTriangles( resolution, resolution, mesh.triangles );
+	ComputeNormals( mesh );
+}
+
+static bool MakeMesh( const std::string& name, benchMesh_t& mesh ) {
+	if ( name == "sphere" ) {
+		MakeSphere( 256, 128, mesh );
+	} else if ( name == "torus" ) {
+		MakeTorus( 256, 96, 1.0f, 0.35f, mesh );
+	} else if ( name == "scan" ) {
+		MakeScan( 512, mesh );
+	} else {
+		return false;
+	}
+	return true;
+}
+
+//////////////////////////////////////////////////////////////////////////
+//
+// Benchmark run
+//
+//////////////////////////////////////////////////////////////////////////
+
+enum benchStage_e {
+	BS_SAMPLE_MESH,
+	BS_KDTREE_BUILD,
+	BS_GROW,
+	BS_TRIM,
+	BS_THICKNESS,
+	BS_CREATE_MESH,
+	BS_NUM_STAGES
+};
+
+static const char* stageNames[ BS_NUM_STAGES ] = {
+	"sampleMesh",
+	"kdTreeBuild",
+	"grow",
+	"trim",
+	"calculateThickness",
+	"createMesh"
+};
+
+struct stageTiming_t {
+	stageTiming_t() : minSeconds( 0 ), totalSeconds( 0 ), numRuns( 0 ) {}
+
+	void Add( double seconds ) {
+		minSeconds = numRuns == 0 ? seconds : std::min( minSeconds, seconds );
+		totalSeconds += seconds;
+		numRuns++;
+	}
+
+	double	minSeconds;
+	double	totalSeconds;
+	int		numRuns;
+};
+
+struct benchRun_t {
+	std::string		mesh;
+	size_t			numTriangles;
+	int				numSamples;
+	size_t			numNodes;
+	growthStats_t	growth;
+	size_t			numActiveNodes;		// after trimming
+	unsigned int	numVertices;
+	unsigned int	numQuads;
+	stageTiming_t	stages[ BS_NUM_STAGES ];
+};
+
+struct benchSettings_t {
+	std::vector< std::string >	meshes;
+	std::vector< int >			samples;
+	int							distribution;
+	int							repeat;
+	std::string					output;
+	bool						check;
+};
+
+static void RunBenchmark( const benchMesh_t& mesh, int numSamples, const benchSettings_t& settings, benchRun_t& run ) {
+	TaskRunner runner;
+	double start;
+
+	run.mesh = mesh.name;
+	run.numTriangles = mesh.NumTriangles();
+	run.numSamples = numSamples;
+
+	triangleMesh_t triMesh;
+	triMesh.positions		= &mesh.positions[ 0 ];
+	triMesh.normals			= &mesh.normals[ 0 ];
+	triMesh.colors			= NULL;
+	triMesh.triangles		= &mesh.triangles[ 0 ];
+	triMesh.numVertices		= mesh.NumVertices();
+	triMesh.numTriangles	= mesh.NumTriangles();
+
+	samplePoints_t samples;
+	for( int i = 0; i < settings.repeat; i++ ) {
+		samplerCache_t cache;
+		start = ProfileSeconds();
+		SampleMesh( triMesh, numSamples, 0, settings.distribution, false, cache, samples, runner );
+		run.stages[ BS_SAMPLE_MESH ].Add( ProfileSeconds() - start );
+	}
+	samples.Update( false );
+
+	KdTree knn;
+	for( int i = 0; i < settings.repeat; i++ ) {
+		start = ProfileSeconds();
+		knn.Init( samples.Size() > 0 ? &samples.positions[ 0 ] : NULL, samples.Size() );
+		run.stages[ BS_KDTREE_BUILD ].Add( ProfileSeconds() - start );
+	}
+
+	// scaled by the sample bounds as the Grower node does
+	const bounds_t& bounds = samples.bounds;
+	const float maxExtents = (float)std::max( bounds.Width(), std::max( bounds.Height(), bounds.Depth() ) );
+	growthParams_t params;
+	params.sourcePos	= samples.Size() > 0 ? samples.Pos( 0 ) : vec3_t( 0, 0, 0 );
+	params.searchRadius	= BENCH_SEARCH_RADIUS * maxExtents;
+	params.killRadius	= BENCH_KILL_RADIUS * maxExtents;
+	params.nodeGrowDist	= BENCH_GROW_DIST * maxExtents;
+	params.maxNeighbors	= BENCH_MAX_NEIGHBORS;
+	params.algorithm	= GA_NODE_CENTRIC;
+
+	growerNodes_t grownNodes;
+	for( int i = 0; i < settings.repeat; i++ ) {
+		growthCache_t cache;
+		start = ProfileSeconds();
+		Grow( samples, knn, params, false, cache, grownNodes, NULL, &run.growth, NULL, runner );
+		run.stages[ BS_GROW ].Add( ProfileSeconds() - start );
+	}
+	run.numNodes = grownNodes.Size();
+
+	growerNodes_t nodes;
+	for( int i = 0; i < settings.repeat; i++ ) {
+		nodes = grownNodes;
+		start = ProfileSeconds();
+		const int maxDepth = GetMaxDepth( nodes );
+		Trim( nodes, (int)ceilf( (float)maxDepth * BENCH_TRIM_LENGTH ) + 1 );
+		run.stages[ BS_TRIM ].Add( ProfileSeconds() - start );
+	}
+
+	// a linear ramp, thick to thin
+	std::vector< float > lut( THICKNESS_LUT_SIZE + 1 );
+	for( int i = 0; i <= THICKNESS_LUT_SIZE; i++ ) {
+		lut[ i ] = 1.0f - (float)i / THICKNESS_LUT_SIZE;
+	}
+	std::vector< float > thickness( std::max( (size_t)1, nodes.Size() ) );
+	for( int i = 0; i < settings.repeat; i++ ) {
+		start = ProfileSeconds();
+		run.numActiveNodes = CalculateThickness( nodes, &lut[ 0 ], BENCH_THICKNESS_SCALE, &thickness[ 0 ], runner );
+		run.stages[ BS_THICKNESS ].Add( ProfileSeconds() - start );
+	}
+
+	growerMeshTopology_t topology;
+	std::vector< float > vertices;
+	std::vector< int > indices;
+	for( int i = 0; i < settings.repeat; i++ ) {
+		start = ProfileSeconds();
+		BuildTopology( nodes, BENCH_TUBE_SECTIONS, topology );
+		CreateMesh( nodes, topology, &thickness[ 0 ], vertices, &indices, runner );
+		run.stages[ BS_CREATE_MESH ].Add( ProfileSeconds() - start );
+	}
+	run.numVertices = topology.numVertices;
+	run.numQuads = topology.numQuads;
+}
+
+//////////////////////////////////////////////////////////////////////////
+//
+// Determinism check
+//
+//	The plugin runs the parallel stages through Maya's thread pool, and
+//	their results must not depend on how the work was split nor on the 
+//	order the tasks complete in. CheckTaskRunner asks for many tasks and
+//	runs them backwards, which is enough to catch results depending on
+//	the task boundaries or on tasks running in order.
+//
+//////////////////////////////////////////////////////////////////////////
+
+#define CHECK_MESH			"sphere"
+#define CHECK_NUM_SAMPLES	2000
+#define CHECK_MAX_TASKS		7
+
+class CheckTaskRunner : public TaskRunner {
+public:
+	CheckTaskRunner() : numSplitRuns( 0 ) {}
+
+	virtual size_t	MaxTasks() const { return CHECK_MAX_TASKS; }
+	virtual void	Run( taskFunc_t func, void* tasks, size_t taskSize, size_t numTasks ) const {
+		if ( numTasks > 1 ) {
+			numSplitRuns++;
+		}
+		for( size_t i = numTasks; i > 0; i-- ) {
+			func( (char*)tasks + ( i - 1 ) * taskSize );
+		}
+	}
+
+	mutable size_t	numSplitRuns;	// Run calls given more than one task
+};
+
+struct checkOutput_t {
+	samplePoints_t			samples;
+	growthParams_t			params;
+	growthCache_t			cache;
+	growerNodes_t			nodes;
+	std::vector< float >	thickness;
+	std::vector< float >	vertices;
+	std::vector< int >		indices;
+};
+
+static void RunPipeline( const triangleMesh_t& triMesh, int distribution, int algorithm, const TaskRunner& runner, checkOutput_t& out ) {
+	samplerCache_t samplerCache;
+	SampleMesh( triMesh, CHECK_NUM_SAMPLES, 0, distribution, false, samplerCache, out.samples, runner );
+	out.samples.Update( false );
+
+	KdTree knn;
+	knn.Init( out.samples.Size() > 0 ? &out.samples.positions[ 0 ] : NULL, out.samples.Size() );
+
+	const bounds_t& bounds = out.samples.bounds;
+	const float maxExtents = (float)std::max( bounds.Width(), std::max( bounds.Height(), bounds.Depth() ) );
+	growthParams_t& params = out.params;
+	params.sourcePos	= out.samples.Size() > 0 ? out.samples.Pos( 0 ) : vec3_t( 0, 0, 0 );
+	params.searchRadius	= BENCH_SEARCH_RADIUS * maxExtents;
+	params.killRadius	= BENCH_KILL_RADIUS * maxExtents;
+	params.nodeGrowDist	= BENCH_GROW_DIST * maxExtents;
+	params.maxNeighbors	= BENCH_MAX_NEIGHBORS;
+	params.algorithm	= algorithm;
+
+	Grow( out.samples, knn, params, false, out.cache, out.nodes, NULL, NULL, NULL, runner );
+	Trim( out.nodes, (int)ceilf( (float)GetMaxDepth( out.nodes ) * BENCH_TRIM_LENGTH ) + 1 );
+
+	std::vector< float > lut( THICKNESS_LUT_SIZE + 1 );
+	for( int i = 0; i <= THICKNESS_LUT_SIZE; i++ ) {
+		lut[ i ] = 1.0f - (float)i / THICKNESS_LUT_SIZE;
+	}
+	out.thickness.resize( std::max( (size_t)1, out.nodes.Size() ) );
+	CalculateThickness( out.nodes, &lut[ 0 ], BENCH_THICKNESS_SCALE, &out.thickness[ 0 ], runner );
+
+	growerMeshTopology_t topology;
+	BuildTopology( out.nodes, BENCH_TUBE_SECTIONS, topology );
+	CreateMesh( out.nodes, topology, &out.thickness[ 0 ], out.vertices, &out.indices, runner );
+}
+
+// bitwise comparison, reports the first mismatch
+template< class T >
+static bool CompareArrays( const char* what, const std::vector< T >& expected, const std::vector< T >& result ) {
+	if ( expected.size() != result.size() ) {
+		fprintf( stderr, "  %s: %lu elements, expected %lu\n", what, (unsigned long)result.size(), (unsigned long)expected.size() );
+		return false;
+	}
+	for( size_t i = 0; i < expected.size(); i++ ) {
+		if ( memcmp( &expected[ i ], &result[ i ], sizeof( T ) ) != 0 ) {
+			fprintf( stderr, "  %s: element %lu differs\n", what, (unsigned long)i );
+			return false;
+		}
+	}
+	return true;
+}
+
+static bool CompareOutputs( const checkOutput_t& expected, const checkOutput_t& result ) {
+	bool same = true;
+	same &= CompareArrays( "sample positions", expected.samples.positions, result.samples.positions );
+	same &= CompareArrays( "sample normals", expected.samples.normals, result.samples.normals );
+	same &= CompareArrays( "node positions", expected.nodes.pos, result.nodes.pos );
+	same &= CompareArrays( "node normals", expected.nodes.surfaceNormal, result.nodes.surfaceNormal );
+	same &= CompareArrays( "node parents", expected.nodes.parent, result.nodes.parent );
+	same &= CompareArrays( "trimmed nodes", expected.nodes.trimmed, result.nodes.trimmed );
+	same &= CompareArrays( "thickness", expected.thickness, result.thickness );
+	same &= CompareArrays( "mesh vertices", expected.vertices, result.vertices );
+	same &= CompareArrays( "mesh indices", expected.indices, result.indices );
+	return same;
+}
+
+// Replays the growth log recorded by the pipeline, which must output the
+// same nodes, and checks the log is smaller than a copy of the closest
+// node array per iteration
+static bool CheckGrowthLog( const checkOutput_t& expected ) {
+	const growthCache_t& cache = expected.cache;
+	const size_t logBytes = cache.assignments.size() * sizeof( growthCache_t::assignment_t ) +
+							cache.bannedAliveNodes.size() * sizeof( sampleIndex_t );
+	const size_t copyBytes = cache.NumIterations() * expected.samples.Size() * sizeof( sampleIndex_t );
+	bool ok = true;
+	if ( logBytes >= copyBytes ) {
+		fprintf( stderr, "  growth log: %lu bytes, not smaller than %lu for the closest node copies\n", (unsigned long)logBytes, (unsigned long)copyBytes );
+		ok = false;
+	}
+
+	KdTree knn;
+	knn.Init( expected.samples.Size() > 0 ? &expected.samples.positions[ 0 ] : NULL, expected.samples.Size() );
+	growthCache_t replayCache = cache;
+	growerNodes_t replayed;
+	Grow( expected.samples, knn, expected.params, true, replayCache, replayed, NULL, NULL, NULL, TaskRunner() );
+	// Trim only flags the nodes, the rest compares as grown
+	ok &= CompareArrays( "replayed node positions", expected.nodes.pos, replayed.pos );
+	ok &= CompareArrays( "replayed node normals", expected.nodes.surfaceNormal, replayed.surfaceNormal );
+	ok &= CompareArrays( "replayed node parents", expected.nodes.parent, replayed.parent );
+	fprintf( stderr, "  growth log: %lu bytes, %.1f%% of the closest node copies\n", (unsigned long)logBytes, copyBytes > 0 ? 100.0 * logBytes / copyBytes : 0.0 );
+	return ok;
+}
+
+// returns the number of failed configurations
+static int CheckDeterminism() {
+	benchMesh_t mesh;
+	MakeMesh( CHECK_MESH, mesh );
+	triangleMesh_t triMesh;
+	triMesh.positions		= &mesh.positions[ 0 ];
+	triMesh.normals			= &mesh.normals[ 0 ];
+	triMesh.colors			= NULL;
+	triMesh.triangles		= &mesh.triangles[ 0 ];
+	triMesh.numVertices		= mesh.NumVertices();
+	triMesh.numTriangles	= mesh.NumTriangles();
+
+	const int distributions[ 2 ] = { SD_RANDOM, SD_POISSON_DISK };
+	const int algorithms[ 2 ] = { GA_NODE_CENTRIC, GA_ATTRACTOR_CENTRIC };
+	int failed = 0;
+	for( int d = 0; d < 2; d++ ) {
+		for( int a = 0; a < 2; a++ ) {
+			const char* distributionName = distributions[ d ] == SD_POISSON_DISK ? "poisson" : "random";
+			const char* algorithmName = algorithms[ a ] == GA_NODE_CENTRIC ? "node centric" : "attractor centric";
+
+			TaskRunner serialRunner;
+			CheckTaskRunner checkRunner;
+			checkOutput_t expected, result;
+			RunPipeline( triMesh, distributions[ d ], algorithms[ a ], serialRunner, expected );
+			RunPipeline( triMesh, distributions[ d ], algorithms[ a ], checkRunner, result );
+
+			const bool same = CompareOutputs( expected, result ) && CheckGrowthLog( expected );
+			fprintf( stderr, "%s, %d %s samples, %s growth: %lu nodes, %lu split runs... %s\n",
+					 CHECK_MESH, CHECK_NUM_SAMPLES, distributionName, algorithmName,
+					 (unsigned long)expected.nodes.Size(), (unsigned long)checkRunner.numSplitRuns, same ? "ok" : "FAILED" );
+			if ( !same ) {
+				failed++;
+			}
+		}
+	}
+	return failed;
+}
+
+//////////////////////////////////////////////////////////////////////////
+//
+// JSON output
+//
+//////////////////////////////////////////////////////////////////////////
+
+static void WriteJson( FILE* out, const benchSettings_t& settings, const std::vector< benchRun_t >& runs ) {
+	fprintf( out, "{\n" );
+	fprintf( out, "\t\"benchmark\": \"GrowerBench\",\n" );
+#ifdef NDEBUG
+	fprintf( out, "\t\"build\": \"release\",\n" );
+#else
+	fprintf( out, "\t\"build\": \"debug\",\n" );
+#endif
+	fprintf( out, "\t\"distribution\": \"%s\",\n", settings.distribution == SD_POISSON_DISK ? "poisson" : "random" );
+	fprintf( out, "\t\"repeat\": %d,\n", settings.repeat );
+	fprintf( out, "\t\"runs\": [" );
+	for( size_t i = 0; i < runs.size(); i++ ) {
+		const benchRun_t& run = runs[ i ];
+		fprintf( out, "%s\n\t\t{\n", i > 0 ? "," : "" );
+		fprintf( out, "\t\t\t\"mesh\": \"%s\",\n", run.mesh.c_str() );
+		fprintf( out, "\t\t\t\"triangles\": %lu,\n", (unsigned long)run.numTriangles );
+		fprintf( out, "\t\t\t\"samples\": %d,\n", run.numSamples );
+		fprintf( out, "\t\t\t\"nodes\": %lu,\n", (unsigned long)run.numNodes );
+		fprintf( out, "\t\t\t\"iterations\": %lu,\n", (unsigned long)run.growth.iterations );
+		fprintf( out, "\t\t\t\"peakAliveNodes\": %lu,\n", (unsigned long)run.growth.peakAliveNodes );
+		fprintf( out, "\t\t\t\"knnQueries\": %lu,\n", (unsigned long)run.growth.knnQueries );
+		fprintf( out, "\t\t\t\"activeNodes\": %lu,\n", (unsigned long)run.numActiveNodes );
+		fprintf( out, "\t\t\t\"meshVertices\": %u,\n", run.numVertices );
+		fprintf( out, "\t\t\t\"meshQuads\": %u,\n", run.numQuads );
+		fprintf( out, "\t\t\t\"stages\": {" );
+		for( int s = 0; s < BS_NUM_STAGES; s++ ) {
+			const stageTiming_t& timing = run.stages[ s ];
+			fprintf( out, "%s\n\t\t\t\t\"%s\": { \"minMs\": %.3f, \"meanMs\": %.3f }",
+					 s > 0 ? "," : "",
+					 stageNames[ s ],
+					 timing.minSeconds * 1000.0,
+					 timing.numRuns > 0 ? timing.totalSeconds * 1000.0 / timing.numRuns : 0.0 );
+		}
+		fprintf( out, "\n\t\t\t}\n\t\t}" );
+	}
+	fprintf( out, "\n\t]\n}\n" );
+}
+
+//////////////////////////////////////////////////////////////////////////
+//
+// Command line
+//
+//////////////////////////////////////////////////////////////////////////
+
+static void SplitList( const char* list, std::vector< std::string >& items ) {
+	items.resize( 0 );
+	std::string s( list );
+	size_t start = 0;
+	while( start <= s.size() ) {
+		size_t end = s.find( ',', start );
+		if ( end == std::string::npos ) {
+			end = s.size();
+		}
+		if ( end > start ) {
+			items.push_back( s.substr( start, end - start ) );
+		}
+		start = end + 1;
+	}
+}
+
+static void PrintUsage() {
+	fprintf( stderr, "usage: GrowerBench [--meshes sphere,torus,scan] [--samples 10000,100000,1000000,5000000]\n"
+					 "                   [--distribution random|poisson] [--repeat 3] [--output results.json]\n"
+					 "       GrowerBench --check\n" );
+}
+
+static bool ParseArgs( int argc, char** argv, benchSettings_t& settings ) {
+	SplitList( "sphere,torus,scan", settings.meshes );
+	settings.samples.resize( 0 );
+	settings.samples.push_back( 10000 );
+	settings.samples.push_back( 100000 );
+	settings.samples.push_back( 1000000 );
+	settings.samples.push_back( 5000000 );
+	settings.distribution = SD_RANDOM;
+	settings.repeat = 3;
+	settings.check = false;
+
+	for( int i = 1; i < argc; i++ ) {
+		const char* arg = argv[ i ];
+		if ( strcmp( arg, "--check" ) == 0 ) {
+			settings.check = true;
+			continue;
+		}
+		const char* value = i + 1 < argc ? argv[ i + 1 ] : NULL;
+		if ( value == NULL ) {
+			return false;
+		}
+		i++;
+		if ( strcmp( arg, "--meshes" ) == 0 ) {
+			SplitList( value, settings.meshes );
+		} else if ( strcmp( arg, "--samples" ) == 0 ) {
+			std::vector< std::string > items;
+			SplitList( value, items );
+			settings.samples.resize( 0 );
+			for( size_t j = 0; j < items.size(); j++ ) {
+				const int numSamples = atoi( items[ j ].c_str() );
+				if ( numSamples <= 0 ) {
+					return false;
+				}
+				settings.samples.push_back( numSamples );
+			}
+		} else if ( strcmp( arg, "--distribution" ) == 0 ) {
+			if ( strcmp( value, "random" ) == 0 ) {
+				settings.distribution = SD_RANDOM;
+			} else if ( strcmp( value, "poisson" ) == 0 ) {
+				settings.distribution = SD_POISSON_DISK;
+			} else {
+				return false;
+			}
+		} else if ( strcmp( arg, "--repeat" ) == 0 ) {
+			settings.repeat = atoi( value );
+			if ( settings.repeat <= 0 ) {
+				return false;
+			}
+		} else if ( strcmp( arg, "--output" ) == 0 ) {
+			settings.output = value;
+		} else {
+			return false;
+		}
+	}
+	return !settings.meshes.empty() && !settings.samples.empty();
+}
+
+int main( int argc, char** argv ) {
+	benchSettings_t settings;
+	if ( !ParseArgs( argc, argv, settings ) ) {
+		PrintUsage();
+		return 1;
+	}
+	if ( settings.check ) {
+		return CheckDeterminism() == 0 ? 0 : 1;
+	}
+#ifndef NDEBUG
+	fprintf( stderr, "warning: GrowerBench was built without NDEBUG, timings include assertions\n" );
+#endif
+
+	std::vector< benchRun_t > runs;
+	for( size_t i = 0; i < settings.meshes.size(); i++ ) {
+		benchMesh_t mesh;
+		if ( !MakeMesh( settings.meshes[ i ], mesh ) ) {
+			fprintf( stderr, "unknown mesh '%s'\n", settings.meshes[ i ].c_str() );
+			return 1;
+		}
+		for( size_t j = 0; j < settings.samples.size(); j++ ) {
+			fprintf( stderr, "%s, %d samples...\n", mesh.name.c_str(), settings.samples[ j ] );
+			runs.push_back( benchRun_t() );
+			RunBenchmark( mesh, settings.samples[ j ], settings, runs.back() );
+		}
+	}
+
+	FILE* out = settings.output.empty() ? stdout : fopen( settings.output.c_str(), "w" );
+	if ( out == NULL ) {
+		fprintf( stderr, "can't open '%s' for writing\n", settings.output.c_str() );
+		return 1;
+	}
+	WriteJson( out, settings, runs );
+	if ( out != stdout ) {
+		fclose( out );
+	}
+	return 0;
+}
@@ -0,0 +1,764 @@
+/* 
+	================================================================================
+	Copyright (c) 2012, Jose Esteve. http://www.joesfer.com
+	This software is released under the LGPL-3.0 license: http://www.opensource.org/licenses/lgpl-3.0.html	
+	================================================================================
+*/
+
+#include "Colonization.h"
+#include "Profiler.h"
+
+#include <assert.h>
+#include <float.h>
+#include <limits.h>
+#include <math.h>
+#include <algorithm>
+
+//////////////////////////////////////////////////////////////////////////
+// growthCache_t
+//////////////////////////////////////////////////////////////////////////
+
+void growthCache_t::Reset() {
+	assignments.resize( 0 );
+	assignmentOffsets.resize( 0 );
+	bannedAliveNodes.resize( 0 );
+	bannedOffsets.resize( 0 );
+	numSamples		= 0;
+	searchRadius	= -1;
+	killRadius		= -1;
+	numNeighbours	= -1;
+	algorithm		= -1;
+	nodeGrowDist	= -1;
+}
+
+// Discards the recorded iterations, leaving the log ready to record a new
+// solution
+void growthCache_t::ClearSolution() {
+	assignments.resize( 0 );
+	assignmentOffsets.resize( 0 );
+	assignmentOffsets.push_back( 0 );
+	bannedAliveNodes.resize( 0 );
+	bannedOffsets.resize( 0 );
+	bannedOffsets.push_back( 0 );
+}
+
+size_t growthCache_t::Bytes() const {
+	return assignments.capacity() * sizeof( assignment_t ) +
+		   bannedAliveNodes.capacity() * sizeof( sampleIndex_t ) +
+		   ( assignmentOffsets.capacity() + bannedOffsets.capacity() ) * sizeof( size_t );
+}
+
+
+//////////////////////////////////////////////////////////////////////////
+//
+// class IndexSet
+//
+//	Set of indices supporting constant time insertion and membership test, 
+//	used to build arrays without duplicates. Every index holds the epoch 
+//	it was last inserted in, so clearing the set just moves on to the
+//	next epoch and the storage is reused across iterations without
+//	touching it.
+//
+//////////////////////////////////////////////////////////////////////////
+
+class IndexSet {
+public:
+	IndexSet() : epoch( 1 ) {}
+
+	void Reserve( size_t maxIndex ) {
+		if ( maxIndex > stamps.size() ) {
+			stamps.resize( maxIndex, 0 );
+		}
+	}
+
+	void Clear() {
+		epoch++;
+		if ( epoch == 0 ) {
+			// wrapped around, old stamps could be mistaken for current ones
+			std::fill( stamps.begin(), stamps.end(), 0 );
+			epoch = 1;
+		}
+	}
+
+	// returns false if the index was already in the set
+	bool Insert( sampleIndex_t s ) {
+		if ( s >= stamps.size() ) {
+			stamps.resize( std::max( (size_t)s + 1, 2 * stamps.size() ), 0 );
+		}
+		if ( stamps[ s ] == epoch ) {
+			return false;
+		}
+		stamps[ s ] = epoch;
+		return true;
+	}
+
+private:
+	std::vector< unsigned int >	stamps;
+	unsigned int				epoch;
+};
+
+inline void insertUnique(std::vector<sampleIndex_t>& v, IndexSet& set, sampleIndex_t s) {
+	if ( set.Insert( s ) ) v.push_back(s);
+}
+
+//////////////////////////////////////////////////////////////////////////
+//
+// Parallel attraction point assignment
+//
+//	The kNN queries issued for each alive node are independent from each 
+//	other, so they are fanned out across the thread pool. Every task owns a 
+//	contiguous range of alive nodes and its own neighbors buffer, and
+//	records the attraction points found within the search radius (along
+//	with their distance). Killed points are no longer returned by the 
+//	kd-tree. Resolving which node is the closest one to 
+//	each attraction point is left to a serial merge which visits the tasks,
+//	and the alive nodes within them, in their original order. This way the
+//	result is exactly the same we would get running the queries serially,
+//	regardless of the number of threads.
+//
+//////////////////////////////////////////////////////////////////////////
+
+struct assignmentCandidate_t {
+	sampleIndex_t	attractor;
+	float			dist;
+};
+
+struct assignmentTask_t {
+	// inputs, shared among all the tasks
+	const KdTree*									knn;
+	const samplePoints_t*							samples;
+	const growerNodes_t*							nodes;
+	const sampleIndex_t*							aliveNodes;
+	float											searchRadius;
+	int												maxNeighbors;
+	
+	// range of alive nodes [first, last) processed by this task
+	size_t											first;
+	size_t											last;
+
+	// per-task storage, reused across iterations
+	std::vector< sampleIndex_t >					neighbors;
+	std::vector< size_t >							candidateOffsets; // last - first + 1 entries into candidates
+	std::vector< assignmentCandidate_t >			candidates;
+};
+
+static void FindAttractorCandidates( void* data ) {
+	assignmentTask_t* task = (assignmentTask_t*)data;
+	
+	const growerNodes_t& nodes = *task->nodes;
+	const samplePoints_t& samples = *task->samples;
+
+	task->neighbors.resize( task->maxNeighbors + 1 );
+	sampleIndex_t* neighbors = &task->neighbors[ 0 ];
+
+	task->candidates.resize( 0 );
+	task->candidateOffsets.resize( 0 );
+
+	for( size_t i = task->first; i < task->last; i++ ) {
+		task->candidateOffsets.push_back( task->candidates.size() );
+
+		const vec3_t aliveNodePos = nodes.Pos( task->aliveNodes[ i ] );
+		size_t found = task->knn->NearestNeighbors( aliveNodePos, task->searchRadius, task->maxNeighbors, neighbors );
+		assert( (int)found <= task->maxNeighbors );
+#if _DEBUG
+		for (size_t j = 0; j < found; j++) {
+			const double d = samples.Pos(neighbors[j]).distanceTo(aliveNodePos);
+			assert(d <= task->searchRadius);
+		}
+#endif
+		for( size_t j = 0; j < found; j++ ) {
+			assignmentCandidate_t candidate;
+			candidate.attractor = neighbors[ j ];
+			candidate.dist		= (float)aliveNodePos.distanceTo( samples.Pos( neighbors[ j ] ) );
+			task->candidates.push_back( candidate );
+		}
+	}
+	task->candidateOffsets.push_back( task->candidates.size() );
+}
+
+//////////////////////////////////////////////////////////////////////////
+//
+// Closest node search (attractor-centric growth)
+//
+//	Each task looks up the closest grower node to a range of the live
+//	attraction points. The results are written into arrays parallel to
+//	the live points, which never overlap between tasks, and compared with
+//	the previous closest nodes by the serial pass which follows.
+//
+//////////////////////////////////////////////////////////////////////////
+
+struct closestNodeTask_t {
+	// inputs, shared among all the tasks
+	const IncrementalKdTree*						nodeTree;
+	const samplePoints_t*							samples;
+	const sampleIndex_t*							attractors;
+	float											searchRadius;
+
+	// range of attraction points [first, last) processed by this task
+	size_t											first;
+	size_t											last;
+
+	// outputs, indexed like the attraction points
+	sampleIndex_t*									closestNode;
+	float*											distance;
+};
+
+static void FindClosestNodes( void* data ) {
+	closestNodeTask_t* task = (closestNodeTask_t*)data;
+	const samplePoints_t& samples = *task->samples;
+
+	for( size_t i = task->first; i < task->last; i++ ) {
+		const sampleIndex_t attractor = task->attractors[ i ];
+		float dist;
+		const size_t closest = task->nodeTree->Nearest( samples.Pos( attractor ), task->searchRadius, dist );
+		if ( closest != IncrementalKdTree::INVALID_INDEX ) {
+			task->closestNode[ i ] = (sampleIndex_t)closest;
+			task->distance[ i ] = dist;
+		} else {
+			task->closestNode[ i ] = UINT_MAX;
+			task->distance[ i ] = FLT_MAX;
+		}
+	}
+}
+
+//////////////////////////////////////////////////////////////////////////
+// growthState_t
+//////////////////////////////////////////////////////////////////////////
+
+void growthState_t::Reset() {
+	nodes.Clear();
+	iterationNodes.resize( 0 );
+	result = GR_ITERATION_LIMIT;	// neither completed nor cut short, free to carry on
+	aliveNodes.resize( 0 );
+	firstChild.resize( 0 );
+	nextSibling.resize( 0 );
+	activeAttractors.resize( 0 );
+	closestNode.resize( 0 );
+	distance.resize( 0 );
+	numKilled = 0;
+	liveAttractors.resize( 0 );
+	nodeTree.Clear();
+}
+
+size_t growthState_t::Bytes() const {
+	return nodes.Bytes() +
+		   iterationNodes.capacity() * sizeof( size_t ) +
+		   ( aliveNodes.capacity() + closestNode.capacity() + liveAttractors.capacity() ) * sizeof( sampleIndex_t ) +
+		   ( firstChild.capacity() + nextSibling.capacity() ) * sizeof( unsigned int ) +
+		   activeAttractors.capacity() / 8 +
+		   distance.capacity() * sizeof( float ) +
+		   nodeTree.Bytes();
+}
+
+//////////////////////////////////////////////////////////////////////////
+// FinishNodes
+//
+//	Sets the normals of the nodes from first on, out of the closest sample
+//	(or their parent), and attaches the ones which turn too sharply to 
+//	their grandparent instead. Both only depend on the node ancestors,
+//	which precede it and are therefore finished already.
+//////////////////////////////////////////////////////////////////////////
+
+static void FinishNodes( const samplePoints_t& samples, const KdTree& knn, const float killRadius, size_t first, growerNodes_t& nodes ) {
+	const vec3_t zero(0,0,0);
+	const double minCosAngle = cos( 3.14159265 / 4 ); // 45 degrees
+	const size_t numNodes = nodes.Size();
+	for( size_t i = first; i < numNodes; i++ ) {
+		const vec3_t pos = nodes.Pos( i );
+		unsigned int parent = nodes.parent[ i ];
+
+		if ( parent != INVALID_PARENT && nodes.parent[ parent ] != INVALID_PARENT ) {
+			const unsigned int grandParent = nodes.parent[ parent ];
+			const vec3_t parentPos = nodes.Pos( parent );
+			vec3_t fromParent = parentPos - nodes.Pos( grandParent );
+			const double fromParentLength = fromParent.length();
+			fromParent /= fromParentLength;
+			vec3_t toChild = pos - parentPos;
+			const double toChildLength = toChild.length();
+			toChild /= toChildLength;
+			const double cosAngle = fromParent * toChild;
+			if ( cosAngle < minCosAngle ) { 
+				parent = grandParent;
+				nodes.parent[ i ] = parent;
+			}
+		}
+
+		// set normals, out of any sample whether it was killed or not
+		const sampleIndex_t neighbor = knn.Nearest( pos, killRadius );
+		if ( neighbor != UINT_MAX ) {
+			nodes.SetNormal( i, samples.Normal( neighbor ) );
+		} else if ( parent != INVALID_PARENT && !nodes.Normal( parent ).isEquivalent( zero, 0.001f ) ) {
+			nodes.SetNormal( i, nodes.Normal( parent ) );
+		} else {
+			nodes.SetNormal( i, vec3_t( 0, 1, 0 ) );
+		}
+	}
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+growthResult_e Grow( const samplePoints_t& samples,
+					 KdTree& knn,
+					 const growthParams_t& params,
+					 bool useCachedSolution,
+					 growthCache_t& cache,
+					 growerNodes_t& nodes,
+					 std::vector< bool >* activeSamples,
+					 growthStats_t* stats,
+					 GrowthMonitor* monitor,
+					 const TaskRunner& runner ) {
+
+	growthState_t state;
+	const growthResult_e result = ContinueGrowth( samples, knn, params, useCachedSolution, cache, state, stats, monitor, runner );
+	if ( result != GR_COMPLETED && !useCachedSolution ) {
+		cache.Reset();
+	}
+	knn.ActivateAll();
+
+	OutputNodes( state, 0, nodes );
+	if ( activeSamples != NULL ) {
+		*activeSamples = state.activeAttractors;
+	}
+	return result;
+}
+
+growthResult_e ContinueGrowth( const samplePoints_t& samples,
+							   KdTree& knn,
+							   const growthParams_t& params,
+							   bool useCachedSolution,
+							   growthCache_t& cache,
+							   growthState_t& state,
+							   growthStats_t* stats,
+							   GrowthMonitor* monitor,
+							   const TaskRunner& runner ) {
+
+	using namespace std;
+
+	const float searchRadius	= params.searchRadius;
+	const float killRadius		= params.killRadius;
+	const float nodeGrowDist	= params.nodeGrowDist;
+	const int maxNeighbors		= params.maxNeighbors;
+	const int algorithm			= params.algorithm;
+
+	growerNodes_t& nodes					= state.nodes;
+	vector< sampleIndex_t >& aliveNodes		= state.aliveNodes;
+	vector< bool >& activeAttractors		= state.activeAttractors;
+	vector< sampleIndex_t >& closestNode	= state.closestNode;
+	vector< float >& distance				= state.distance;
+
+	// while growing, the children of each node are kept as a linked list
+	// through these arrays, the flat children ranges are built at the end
+	vector< unsigned int >& firstChild		= state.firstChild;
+	vector< unsigned int >& nextSibling		= state.nextSibling;
+
+	// the attractor-centric growth keeps the nodes indexed by a kd-tree
+	// (using the same indices as the nodes array) and the list of the 
+	// attraction points which haven't been killed yet.
+	IncrementalKdTree& nodeTree				= state.nodeTree;
+	vector< sampleIndex_t >& liveAttractors	= state.liveAttractors;
+
+	const bool generateSolutionCache = !useCachedSolution;
+
+	const size_t firstNewNode = nodes.Size();
+	if ( !state.Started() ) {
+		activeAttractors.assign( samples.Size(), true );
+		closestNode.assign( samples.Size(), UINT_MAX );
+		distance.assign( samples.Size(), FLT_MAX );
+
+		nodes.Add( params.sourcePos, INVALID_PARENT );
+		firstChild.push_back( UINT_MAX );
+		nextSibling.push_back( UINT_MAX );
+		aliveNodes.push_back( 0 );
+		state.iterationNodes.push_back( 1 );
+
+		if ( algorithm == GA_ATTRACTOR_CENTRIC ) {
+			nodeTree.Insert( nodes.Pos( 0 ) );
+			liveAttractors.resize( samples.Size() );
+			for( size_t i = 0; i < samples.Size(); i++ ) { 
+				liveAttractors[ i ] = (sampleIndex_t)i;
+			}
+		}
+
+		if (generateSolutionCache)
+		{
+			cache.ClearSolution();
+		}
+	}
+
+	vector< sampleIndex_t > affectedPoints;
+	vector< sampleIndex_t > bannedAliveNodes;
+	vector< sampleIndex_t > killedAttractors;
+	vector< sampleIndex_t > foundNodes;			// attractor-centric, parallel to liveAttractors
+	vector< float > foundDistances;
+	IndexSet affectedPointsSet;
+	IndexSet aliveNodesSet;
+	affectedPointsSet.Reserve( samples.Size() );
+
+	// split the alive nodes in a few more chunks than threads so that the
+	// workload is balanced even if some regions of the mesh are denser
+	// than others. Small fronts are not worth the task overhead.
+	const size_t minNodesPerTask = 32;
+	const size_t maxTasks = runner.MaxTasks() > 0 ? runner.MaxTasks() : 1;
+	vector< assignmentTask_t > assignmentTasks( maxTasks );
+	for( size_t i = 0; i < assignmentTasks.size(); i++ ) {
+		assignmentTask_t& task = assignmentTasks[ i ];
+		task.knn				= &knn;
+		task.samples			= &samples;
+		task.nodes				= &nodes;
+		task.aliveNodes			= NULL;
+		task.searchRadius		= searchRadius;
+		task.maxNeighbors		= maxNeighbors;
+		task.first				= 0;
+		task.last				= 0;
+	}
+	vector< closestNodeTask_t > closestNodeTasks( maxTasks );
+	for( size_t i = 0; i < closestNodeTasks.size(); i++ ) {
+		closestNodeTask_t& task = closestNodeTasks[ i ];
+		task.nodeTree		= &nodeTree;
+		task.samples		= &samples;
+		task.attractors		= NULL;
+		task.searchRadius	= searchRadius;
+		task.first			= 0;
+		task.last			= 0;
+		task.closestNode	= NULL;
+		task.distance		= NULL;
+	}
+
+	const size_t numCachedIterations = cache.NumIterations();
+	growthStats_t counters;
+
+	// the progress is measured by the iterations if they're limited,
+	// otherwise by the attraction points killed, or by the iterations 
+	// replayed when reading the cache (which kills none)
+	const double startTime = ProfileSeconds();
+	growthResult_e result = state.Finished() ? state.result : GR_COMPLETED;
+
+	while( !aliveNodes.empty() && !state.Finished() ) {
+		const size_t iterationCount = state.NumIterations();
+		if ( params.maxIterations > 0 && iterationCount >= params.maxIterations ) {
+			result = GR_ITERATION_LIMIT;
+			break;
+		}
+		if ( useCachedSolution && iterationCount >= numCachedIterations ) {
+			// nothing else was recorded
+			break;
+		}
+		if ( params.timeBudget > 0 && ProfileSeconds() - startTime > params.timeBudget ) {
+			result = GR_TIME_LIMIT;
+			break;
+		}
+		if ( monitor != NULL ) {
+			float progress = 1.0f;
+			if ( params.maxIterations > 0 ) {
+				progress = (float)iterationCount / params.maxIterations;
+			} else if ( useCachedSolution ) {
+				progress = numCachedIterations > 0 ? (float)iterationCount / numCachedIterations : 1.0f;
+			} else if ( samples.Size() > 0 ) {
+				const size_t numLive = algorithm == GA_ATTRACTOR_CENTRIC ? liveAttractors.size() : samples.Size() - state.numKilled;
+				progress = 1.0f - (float)numLive / samples.Size();
+			}
+			if ( !monitor->Continue( progress ) ) {
+				result = GR_INTERRUPTED;
+				break;
+			}
+		}
+
+		counters.iterations++;
+		counters.peakAliveNodes = std::max( counters.peakAliveNodes, aliveNodes.size() );
+
+		vector< sampleIndex_t > newNodes;
+		{
+			affectedPoints.resize(0);
+			affectedPointsSet.Clear();
+
+			if (useCachedSolution)
+			{
+				// only the closest node of the affected points is read below,
+				// so restoring those entries is enough to replay the iteration
+				const size_t assignmentsBegin = cache.assignmentOffsets[iterationCount];
+				const size_t assignmentsEnd	  = cache.assignmentOffsets[iterationCount + 1];
+				for (size_t i = assignmentsBegin; i < assignmentsEnd; i++) {
+					const growthCache_t::assignment_t& assignment = cache.assignments[i];
+					if (algorithm == GA_ATTRACTOR_CENTRIC) {
+						if (assignment.node == UINT_MAX) {
+							activeAttractors[assignment.attractor] = false;
+						} else {
+							closestNode[assignment.attractor] = assignment.node;
+						}
+					} else {
+						affectedPoints.push_back(assignment.attractor);
+						closestNode[assignment.attractor] = assignment.node;
+					}
+				}
+
+				bannedAliveNodes.assign(cache.bannedAliveNodes.begin() + cache.bannedOffsets[iterationCount],
+										cache.bannedAliveNodes.begin() + cache.bannedOffsets[iterationCount + 1]);
+			}
+			else
+			{
+				if (algorithm == GA_ATTRACTOR_CENTRIC) {
+					// find the closest node to each live attraction point
+					foundNodes.resize( liveAttractors.size() );
+					foundDistances.resize( liveAttractors.size() );
+					const size_t numTasks = std::max( (size_t)1, std::min( maxTasks, liveAttractors.size() / ( 8 * minNodesPerTask ) ) );
+					const size_t attractorsPerTask = ( liveAttractors.size() + numTasks - 1 ) / numTasks;
+					for (size_t i = 0; i < numTasks; i++) {
+						closestNodeTask_t& task = closestNodeTasks[i];
+						task.attractors = liveAttractors.empty() ? NULL : &liveAttractors[0];
+						task.first		= std::min( liveAttractors.size(), i * attractorsPerTask );
+						task.last		= std::min( liveAttractors.size(), task.first + attractorsPerTask );
+						task.closestNode = foundNodes.empty() ? NULL : &foundNodes[0];
+						task.distance	 = foundDistances.empty() ? NULL : &foundDistances[0];
+					}
+					RunTasks(runner, FindClosestNodes, closestNodeTasks, numTasks);
+					counters.knnQueries += liveAttractors.size();
+
+					// attraction points reached by a node are killed, only the
+					// kills and the closest nodes which changed are logged. Nodes
+					// are never removed, so once found the closest node doesn't 
+					// go back to UINT_MAX.
+					for (size_t i = 0; i < liveAttractors.size(); i++) {
+						growthCache_t::assignment_t assignment;
+						assignment.attractor = liveAttractors[i];
+						if (foundNodes[i] != UINT_MAX && foundDistances[i] <= killRadius) {
+							activeAttractors[assignment.attractor] = false;
+							assignment.node = UINT_MAX;
+						} else if (foundNodes[i] != closestNode[assignment.attractor]) {
+							closestNode[assignment.attractor] = foundNodes[i];
+							assignment.node = foundNodes[i];
+						} else {
+							continue;
+						}
+						if (generateSolutionCache) {
+							cache.assignments.push_back(assignment);
+						}
+					}
+				} else {
+					// find the closest attraction point to each alive node
+					const size_t numTasks = std::max( (size_t)1, std::min( maxTasks, aliveNodes.size() / minNodesPerTask ) );
+					const size_t nodesPerTask = ( aliveNodes.size() + numTasks - 1 ) / numTasks;
+					for (size_t i = 0; i < numTasks; i++) {
+						assignmentTask_t& task = assignmentTasks[i];
+						task.aliveNodes = &aliveNodes[0];
+						task.first		= std::min( aliveNodes.size(), i * nodesPerTask );
+						task.last		= std::min( aliveNodes.size(), task.first + nodesPerTask );
+					}
+
+					RunTasks(runner, FindAttractorCandidates, assignmentTasks, numTasks);
+					counters.knnQueries += aliveNodes.size();
+
+					// merge the candidates following the alive nodes order, ties are
+					// resolved in favor of the first node found.
+					for (size_t t = 0; t < numTasks; t++) {
+						const assignmentTask_t& task = assignmentTasks[t];
+						for (size_t i = task.first; i < task.last; i++) {
+							const sampleIndex_t aliveNode = aliveNodes[i];
+							const size_t candidatesBegin = task.candidateOffsets[i - task.first];
+							const size_t candidatesEnd	 = task.candidateOffsets[i - task.first + 1];
+							for (size_t j = candidatesBegin; j < candidatesEnd; j++) {
+								const sampleIndex_t neighbor = task.candidates[j].attractor;
+								const float dist = task.candidates[j].dist;
+
+								insertUnique(affectedPoints, affectedPointsSet, neighbor);
+
+								if (closestNode[neighbor] != UINT_MAX) {
+									if (closestNode[neighbor] != aliveNode) {
+										if (dist < distance[neighbor]) {
+											closestNode[neighbor] = aliveNode;
+											distance[neighbor] = dist;
+										}
+									}
+								}
+								else 
+								{
+									closestNode[neighbor] = aliveNode;
+									distance[neighbor] = dist;
+								}
+							} // for candidates
+						} // for alive nodes
+					} // for tasks
+
+					if (generateSolutionCache)
+					{
+						for (size_t i = 0; i < affectedPoints.size(); i++) {
+							growthCache_t::assignment_t assignment;
+							assignment.attractor = affectedPoints[i];
+							assignment.node		 = closestNode[affectedPoints[i]];
+							cache.assignments.push_back(assignment);
+						}
+					}
+				}
+
+				if (generateSolutionCache)
+				{
+					cache.assignmentOffsets.push_back(cache.assignments.size());
+				}
+				
+			} // else useCachedSolution
+
+			if (algorithm == GA_ATTRACTOR_CENTRIC) {
+				// drop the killed attraction points, the ones left within the 
+				// search radius of a node affect its growth
+				size_t numLive = 0;
+				for (size_t i = 0; i < liveAttractors.size(); i++) {
+					const sampleIndex_t attractor = liveAttractors[i];
+					if (!activeAttractors[attractor]) continue;
+					if (closestNode[attractor] != UINT_MAX) {
+						affectedPoints.push_back(attractor);
+					}
+					liveAttractors[numLive++] = attractor;
+				}
+				liveAttractors.resize(numLive);
+			}
+			
+			// those nodes which are marked as closest to an attraction point
+			// are the candidates to spawn new nodes, and therefore are the
+			// only ones which remain active for the next iteration
+			aliveNodes.resize(0);
+			aliveNodesSet.Clear();
+			for( size_t i = 0; i < affectedPoints.size(); i++ ) {
+				sampleIndex_t node = closestNode[affectedPoints[i]];
+				insertUnique(aliveNodes, aliveNodesSet, node);
+			}
+
+			// spawn new nodes	
+			for( size_t i = 0; i < aliveNodes.size(); i++ ) {
+
+				const sampleIndex_t& nodeIdx = aliveNodes[i];
+				const vec3_t srcPos = nodes.Pos( nodeIdx );
+
+				vec3_t growDirection( 0, 0, 0 );
+				size_t nAttractors = 0;
+
+				for( size_t j = 0; j < affectedPoints.size(); j++ ) {
+					if ( closestNode[affectedPoints[j]] != nodeIdx ) continue;
+
+					nAttractors ++;
+					vec3_t dir = samples.Pos(affectedPoints[j]) - srcPos;
+					dir.normalize();
+					growDirection += dir;
+				}
+
+				assert( nAttractors > 0 );
+				growDirection.normalize();
+
+				const vec3_t newPos = srcPos + nodeGrowDist * growDirection;
+
+				bool duplicated = false;
+				if (generateSolutionCache)
+				{ 
+					for (unsigned int child = firstChild[nodeIdx]; child != UINT_MAX; child = nextSibling[child]) {
+						if (nodes.Pos(child).distanceTo(newPos) <= 0.0001f) {
+							duplicated = true;
+							cache.bannedAliveNodes.push_back(nodeIdx);
+							break;
+						}
+					}
+				}
+				else
+				{
+					for (size_t j = 0; j < bannedAliveNodes.size(); ++j)
+					{
+						if (bannedAliveNodes[j] == nodeIdx)
+						{
+							duplicated = true;
+							break;
+						}
+					}
+				}
+
+				if ( !duplicated && params.maxNodes > 0 && nodes.Size() >= params.maxNodes ) {
+					// leave the rest of the iteration out, the growth stops below
+					result = GR_NODE_LIMIT;
+					break;
+				}
+
+				if ( duplicated ) {
+					// erase active element, as it is stuck in a loop trying to produce the same children
+				
+					aliveNodes[ i ] = aliveNodes[ aliveNodes.size() - 1 ];
+					aliveNodes.resize( aliveNodes.size() - 1 );
+					i--;		
+				
+				} else {
+					sampleIndex_t newNodeIdx = nodes.Add( newPos, nodeIdx );
+					firstChild.push_back( UINT_MAX );
+					nextSibling.push_back( firstChild[ nodeIdx ] );
+					firstChild[ nodeIdx ] = newNodeIdx;
+					newNodes.push_back( newNodeIdx );
+				}
+			}
+			if (generateSolutionCache)
+			{
+				cache.bannedOffsets.push_back(cache.bannedAliveNodes.size());
+			}
+			for( size_t i = 0; i < newNodes.size(); i++ ) { 
+				aliveNodes.push_back( newNodes[ i ] );
+			}
+			if ( algorithm == GA_ATTRACTOR_CENTRIC ) {
+				for( size_t i = 0; i < newNodes.size(); i++ ) {
+					const size_t treeIdx = nodeTree.Insert( nodes.Pos( newNodes[ i ] ) );
+					assert( treeIdx == newNodes[ i ] );
+					(void)treeIdx;
+				}
+			}
+		}
+
+		// use the new spawned nodes to kill close attractor points (the 
+		// attractor-centric growth does so while looking for the closest nodes)
+		if (generateSolutionCache && algorithm == GA_NODE_CENTRIC)
+		{
+			counters.knnQueries += newNodes.size();
+			for (size_t i = 0; i < newNodes.size(); i++) {
+				knn.PointsInRadius(nodes.Pos(newNodes[i]), killRadius, killedAttractors);
+				state.numKilled += killedAttractors.size();
+				for (size_t j = 0; j < killedAttractors.size(); j++) {
+					knn.Deactivate(killedAttractors[j]);
+					activeAttractors[killedAttractors[j]] = false;
+				}
+			}
+		}
+
+		state.iterationNodes.push_back( nodes.Size() );
+
+		if ( result != GR_COMPLETED ) {
+			break;
+		}
+	
+	} // while alive
+
+	if ( aliveNodes.empty() || ( useCachedSolution && state.NumIterations() >= numCachedIterations ) ) {
+		result = GR_COMPLETED;
+	}
+	state.result = result;
+
+	FinishNodes( samples, knn, killRadius, firstNewNode, nodes );
+	counters.knnQueries += nodes.Size() - firstNewNode;
+
+	if ( stats != NULL ) {
+		*stats = counters;
+	}
+	return result;
+}
+
+void RestoreKilledSamples( const growthState_t& state, KdTree& knn ) {
+	knn.ActivateAll();
+	for( size_t i = 0; i < state.activeAttractors.size(); i++ ) {
+		if ( !state.activeAttractors[ i ] ) {
+			knn.Deactivate( (sampleIndex_t)i );
+		}
+	}
+}
+
+void OutputNodes( const growthState_t& state, size_t numIterations, growerNodes_t& nodes ) {
+	if ( numIterations == 0 || numIterations > state.NumIterations() ) {
+		numIterations = state.NumIterations();
+	}
+	const size_t numNodes = state.Started() ? state.iterationNodes[ numIterations ] : 0;
+	const growerNodes_t& grown = state.nodes;
+	nodes.pos.assign( grown.pos.begin(), grown.pos.begin() + 3 * numNodes );
+	nodes.surfaceNormal.assign( grown.surfaceNormal.begin(), grown.surfaceNormal.begin() + 3 * numNodes );
+	nodes.parent.assign( grown.parent.begin(), grown.parent.begin() + numNodes );
+	nodes.trimmed.assign( numNodes, 0 );
+	nodes.LinkChildren();
+}
@@ -0,0 +1,217 @@
+/* 
+	================================================================================
+	Copyright (c) 2012, Jose Esteve. http://www.joesfer.com
+	This software is released under the LGPL-3.0 license: http://www.opensource.org/licenses/lgpl-3.0.html	
+	================================================================================
+*/
+
+#ifndef Colonization_h__
+#define Colonization_h__
+
+#include "Vector.h"
+#include "GrowerNodes.h"
+#include "SamplePoints.h"
+#include "NearestNeighbors.h"
+#include "TaskRunner.h"
+#include <stddef.h>
+#include <vector>
+
+//////////////////////////////////////////////////////////////////////////
+//
+// Space colonization
+//
+//	Grows a hierarchy of nodes from a source position towards the
+//	attraction points: on every iteration each attraction point pulls the
+//	node closest to it, every node pulled spawns a child towards the
+//	average direction of its attraction points, and the attraction points
+//	reached by a node are killed. The growth stops once no node is pulled,
+//	or earlier if it runs out of its iteration, node or time budget or the
+//	GrowthMonitor asks to, in which case the nodes grown so far are kept.
+//	A growth kept in a growthState_t can be carried on later on.
+//
+//////////////////////////////////////////////////////////////////////////
+
+enum growthAlgorithm_e {
+	GA_NODE_CENTRIC			= 0,	// look for the attraction points around each alive node
+	GA_ATTRACTOR_CENTRIC	= 1		// look for the closest node to each active attraction point (Runions et al.)
+};
+
+enum growthResult_e {
+	GR_COMPLETED		= 0,	// no node is pulled anymore
+	GR_INTERRUPTED		= 1,	// by the GrowthMonitor
+	GR_NODE_LIMIT		= 2,	// maxNodes reached
+	GR_TIME_LIMIT		= 3,	// timeBudget exceeded
+	GR_ITERATION_LIMIT	= 4		// maxIterations reached
+};
+
+struct growthParams_t {
+	growthParams_t() : searchRadius( 0 ), killRadius( 0 ), nodeGrowDist( 0 ), maxNeighbors( 0 ), algorithm( GA_NODE_CENTRIC ), maxIterations( 0 ), maxNodes( 0 ), timeBudget( 0 ) {}
+
+	vec3_t	sourcePos;
+	float	searchRadius;	// absolute distances
+	float	killRadius;
+	float	nodeGrowDist;
+	int		maxNeighbors;
+	int		algorithm;		// growthAlgorithm_e
+	size_t	maxIterations;	// 0 for no limit
+	size_t	maxNodes;		// 0 for no limit
+	double	timeBudget;		// seconds, 0 for no limit
+};
+
+/////////////////////////////////////////////////////////////////////
+//
+// class GrowthMonitor
+//
+//	Polled before every growth iteration, to report the progress to the
+//	user and let them stop the growth.
+//
+/////////////////////////////////////////////////////////////////////
+
+class GrowthMonitor {
+public:
+	virtual			~GrowthMonitor() {}
+
+	// progress goes from 0 to 1, returning false stops the growth
+	virtual bool	Continue( float progress ) = 0;
+};
+
+/////////////////////////////////////////////////////////////////////
+//
+// struct growthCache_t
+//
+//	Log of a growth, used to replay it without any of the spatial
+//	queries. Rather than storing the whole closest node array on every
+//	iteration, we only record what changed in it, and the alive nodes
+//	which got stuck. The node-centric growth records the attraction 
+//	points which affected the growth, in order, along with the node they
+//	were assigned to. The attractor-centric growth affects every live
+//	attraction point with a node in range, in the order they're kept,
+//	so it only records the points whose closest node changed and the 
+//	ones killed (with UINT_MAX as node). The records for iteration i are
+//	found in the range [ offsets[ i ], offsets[ i + 1 ] ) of each array.
+//	The (relative)
+//	settings the log was recorded with are kept along with it, so that
+//	callers can tell whether it still applies.
+//
+/////////////////////////////////////////////////////////////////////
+
+struct growthCache_t {
+	growthCache_t() { Reset(); }
+
+	void	Reset();			// no log and no settings
+	void	ClearSolution();	// ready to record a new log
+	size_t	NumIterations() const { return bannedOffsets.empty() ? 0 : bannedOffsets.size() - 1; }
+	size_t	Bytes() const;		// memory held by the log
+
+	struct assignment_t {
+		sampleIndex_t attractor;
+		sampleIndex_t node;
+	};
+	std::vector< assignment_t >		assignments;
+	std::vector< size_t >			assignmentOffsets;
+	std::vector< sampleIndex_t >	bannedAliveNodes;
+	std::vector< size_t >			bannedOffsets;
+
+	unsigned int	numSamples;
+	float			searchRadius;
+	float			killRadius;
+	int				numNeighbours;
+	int				algorithm;
+	float			nodeGrowDist;
+};
+
+/////////////////////////////////////////////////////////////////////
+//
+// struct growthState_t
+//
+//	A growth in progress, which ContinueGrowth carries on from where it
+//	stopped. The nodes are kept the way OutputNodes hands them out (with
+//	their normals set and the sharp turns straightened, which only
+//	depends on their ancestors) and in the order they were grown: the
+//	first i iterations grew the range [ 0, iterationNodes[ i ] ), so any
+//	earlier iteration can be output again without growing anything.
+//	The rest is what the growth loop needs to go on: the growth front,
+//	the children as grown and the attraction points left.
+//
+/////////////////////////////////////////////////////////////////////
+
+struct growthState_t {
+	growthState_t() { Reset(); }
+
+	void	Reset();			// nothing grown
+	bool	Started() const { return !iterationNodes.empty(); }
+	bool	Finished() const { return result == GR_COMPLETED || result == GR_NODE_LIMIT; }
+	size_t	NumIterations() const { return iterationNodes.empty() ? 0 : iterationNodes.size() - 1; }
+	size_t	Bytes() const;		// memory held by the state
+
+	growerNodes_t					nodes;				// without the children ranges
+	std::vector< size_t >			iterationNodes;		// NumIterations() + 1 entries
+	growthResult_e					result;				// how the growth last stopped
+
+	std::vector< sampleIndex_t >	aliveNodes;
+	std::vector< unsigned int >		firstChild;			// children as grown, as linked lists
+	std::vector< unsigned int >		nextSibling;
+	std::vector< bool >				activeAttractors;
+	std::vector< sampleIndex_t >	closestNode;		// per attraction point, carried across iterations
+	std::vector< float >			distance;
+	size_t							numKilled;			// node-centric growth
+	std::vector< sampleIndex_t >	liveAttractors;		// attractor-centric growth
+	IncrementalKdTree				nodeTree;			// attractor-centric growth
+};
+
+// Counters of a growth, for profiling
+struct growthStats_t {
+	growthStats_t() : iterations( 0 ), peakAliveNodes( 0 ), knnQueries( 0 ) {}
+
+	size_t	iterations;
+	size_t	peakAliveNodes;	// largest growth front
+	size_t	knnQueries;		// spatial queries, over both the samples and the nodes
+};
+
+// Grows nodes out of the samples in one go. knn must be built over the
+// sample positions with every point active, and is left that way. The
+// cache is either replayed (useCachedSolution) or recorded, a log
+// recorded by a growth which stopped early is reset so that it isn't
+// replayed as a whole one. If given, activeSamples receives which
+// samples were never reached by a node, stats the growth counters, and
+// monitor is polled along the growth.
+growthResult_e Grow( const samplePoints_t& samples,
+					 KdTree& knn,
+					 const growthParams_t& params,
+					 bool useCachedSolution,
+					 growthCache_t& cache,
+					 growerNodes_t& nodes,
+					 std::vector< bool >* activeSamples,
+					 growthStats_t* stats,
+					 GrowthMonitor* monitor,
+					 const TaskRunner& runner );
+
+// Carries on the growth in state, starting it at params.sourcePos if
+// the state is empty. params.maxIterations counts the iterations of the
+// whole growth, not of this call. The samples, params (but for the
+// limits) and useCachedSolution must be the ones the state was started
+// with: the cache is replayed, up to its last iteration, or recorded
+// along with the state. knn must be built over the sample positions with
+// the samples killed by the state deactivated, and is left that way for
+// the next call (see RestoreKilledSamples). If given, stats receives the
+// counters of this call only.
+growthResult_e ContinueGrowth( const samplePoints_t& samples,
+							   KdTree& knn,
+							   const growthParams_t& params,
+							   bool useCachedSolution,
+							   growthCache_t& cache,
+							   growthState_t& state,
+							   growthStats_t* stats,
+							   GrowthMonitor* monitor,
+							   const TaskRunner& runner );
+
+// Deactivates the samples killed by the state in knn, and activates the
+// rest, for ContinueGrowth to carry on a state with an index which wasn't
+// left by its previous call.
+void RestoreKilledSamples( const growthState_t& state, KdTree& knn );
+
+// Outputs the nodes grown by the first numIterations iterations of the
+// state, or all of them if 0.
+void OutputNodes( const growthState_t& state, size_t numIterations, growerNodes_t& nodes );
+
+#endif // Colonization_h__
@@ -0,0 +1,82 @@
+/* 
+	================================================================================
+	Copyright (c) 2012, Jose Esteve. http://www.joesfer.com
+	This software is released under the LGPL-3.0 license: http://www.opensource.org/licenses/lgpl-3.0.html	
+	================================================================================
+*/
+
+#include "GrowerNodes.h"
+
+//////////////////////////////////////////////////////////////////////////
+// growerNodes_t
+//////////////////////////////////////////////////////////////////////////
+
+void growerNodes_t::Clear() {
+	Resize( 0 );
+}
+
+void growerNodes_t::Resize( size_t numNodes ) {
+	pos.resize( 3 * numNodes, 0 );
+	surfaceNormal.resize( 3 * numNodes, 0 );
+	parent.resize( numNodes, INVALID_PARENT );
+	trimmed.resize( numNodes, 0 );
+	childOffset.assign( numNodes + 1, 0 );
+	children.resize( 0 );
+	segments.resize( 0 );
+}
+
+void growerNodes_t::Reserve( size_t numNodes ) {
+	pos.reserve( 3 * numNodes );
+	surfaceNormal.reserve( 3 * numNodes );
+	parent.reserve( numNodes );
+	trimmed.reserve( numNodes );
+}
+
+size_t growerNodes_t::Bytes() const {
+	return ( pos.capacity() + surfaceNormal.capacity() ) * sizeof( float ) +
+		   ( parent.capacity() + childOffset.capacity() + children.capacity() + segments.capacity() ) * sizeof( unsigned int ) +
+		   trimmed.capacity();
+}
+
+// Appends a node, the children arrays are left untouched until LinkChildren
+unsigned int growerNodes_t::Add( const vec3_t& p, unsigned int parentIdx ) {
+	const unsigned int idx = (unsigned int)parent.size();
+	pos.push_back( (float)p.x );
+	pos.push_back( (float)p.y );
+	pos.push_back( (float)p.z );
+	surfaceNormal.resize( surfaceNormal.size() + 3, 0 );
+	parent.push_back( parentIdx );
+	trimmed.push_back( 0 );
+	return idx;
+}
+
+// Builds the children ranges out of the parent indices (counting sort), the
+// children of each node are listed in increasing index order. The segments
+// list is rebuilt as well.
+void growerNodes_t::LinkChildren() {
+	const size_t numNodes = Size();
+	childOffset.assign( numNodes + 1, 0 );
+	for( size_t i = 0; i < numNodes; i++ ) {
+		if ( parent[ i ] != INVALID_PARENT ) {
+			childOffset[ parent[ i ] + 1 ]++;
+		}
+	}
+	for( size_t i = 0; i < numNodes; i++ ) {
+		childOffset[ i + 1 ] += childOffset[ i ];
+	}
+	children.resize( childOffset[ numNodes ] );
+	std::vector< unsigned int > cursor( childOffset.begin(), childOffset.end() - 1 );
+	for( size_t i = 0; i < numNodes; i++ ) {
+		if ( parent[ i ] != INVALID_PARENT ) {
+			children[ cursor[ parent[ i ] ]++ ] = (unsigned int)i;
+		}
+	}
+
+	segments.resize( 2 * children.size() );
+	for( size_t i = 0; i < numNodes; i++ ) {
+		for( unsigned int j = childOffset[ i ]; j < childOffset[ i + 1 ]; j++ ) {
+			segments[ 2 * j ] = (unsigned int)i;
+			segments[ 2 * j + 1 ] = children[ j ];
+		}
+	}
+}
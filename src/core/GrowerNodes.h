@@ -0,0 +1,57 @@
+/* 
+	================================================================================
+	Copyright (c) 2012, Jose Esteve. http://www.joesfer.com
+	This software is released under the LGPL-3.0 license: http://www.opensource.org/licenses/lgpl-3.0.html	
+	================================================================================
+*/
+
+#ifndef GrowerNodes_h__
+#define GrowerNodes_h__
+
+#include "Vector.h"
+#include <stddef.h>
+#include <vector>
+
+#define INVALID_PARENT	1 << 30
+
+/////////////////////////////////////////////////////////////////////
+//
+// struct growerNodes_t
+//
+//	The grown hierarchy, stored as flat arrays indexed by node rather than
+//	one structure (and children allocation) per node. Positions and normals
+//	take 3 floats per node. The children of node i are stored contiguously
+//	in the range [ childOffset[ i ], childOffset[ i + 1 ] ) of the children
+//	array, which is built out of the parent indices by LinkChildren along
+//	with the (node, child) index pairs used to draw the hierarchy.
+//
+/////////////////////////////////////////////////////////////////////
+
+struct growerNodes_t {
+
+	size_t			Size() const { return parent.size(); }
+	void			Clear();
+	void			Resize( size_t numNodes );
+	void			Reserve( size_t numNodes );
+	unsigned int	Add( const vec3_t& p, unsigned int parentIdx );
+	void			LinkChildren();
+	size_t			Bytes() const;	// memory held by the arrays
+
+	vec3_t			Pos( size_t i ) const { return vec3_t( &pos[ 3 * i ] ); }
+	vec3_t			Normal( size_t i ) const { return vec3_t( &surfaceNormal[ 3 * i ] ); }
+	void			SetPos( size_t i, const vec3_t& p ) { p.get( &pos[ 3 * i ] ); }
+	void			SetNormal( size_t i, const vec3_t& n ) { n.get( &surfaceNormal[ 3 * i ] ); }
+
+	unsigned int	NumChildren( size_t i ) const { return childOffset[ i + 1 ] - childOffset[ i ]; }
+	unsigned int	Child( size_t i, unsigned int j ) const { return children[ childOffset[ i ] + j ]; }
+
+	std::vector< float >			pos;
+	std::vector< float >			surfaceNormal;
+	std::vector< unsigned int >		parent;
+	std::vector< unsigned char >	trimmed;
+	std::vector< unsigned int >		childOffset;	// Size() + 1 entries
+	std::vector< unsigned int >		children;
+	std::vector< unsigned int >		segments;		// ( node, child ) pairs, in children order
+};
+
+#endif // GrowerNodes_h__
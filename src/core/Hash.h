@@ -0,0 +1,36 @@
+/* 
+	================================================================================
+	Copyright (c) 2012, Jose Esteve. http://www.joesfer.com
+	This software is released under the LGPL-3.0 license: http://www.opensource.org/licenses/lgpl-3.0.html	
+	================================================================================
+*/
+
+#ifndef Hash_h__
+#define Hash_h__
+
+#include <stddef.h>
+
+//////////////////////////////////////////////////////////////////////////
+//
+// 64 bit FNV-1a hashing, used to tell whether cached results were 
+// computed out of the same inputs.
+//
+//////////////////////////////////////////////////////////////////////////
+
+#define HASH_SEED	14695981039346656037ULL
+
+inline unsigned long long HashBytes( unsigned long long hash, const void* data, size_t size ) {
+	const unsigned char* bytes = (const unsigned char*)data;
+	for( size_t i = 0; i < size; i++ ) {
+		hash ^= bytes[ i ];
+		hash *= 1099511628211ULL;
+	}
+	return hash;
+}
+
+template< class T >
+inline unsigned long long HashValue( unsigned long long hash, const T& value ) {
+	return HashBytes( hash, &value, sizeof( T ) );
+}
+
+#endif // Hash_h__
@@ -0,0 +1,435 @@
+/* 
+	================================================================================
+	Copyright (c) 2012, Jose Esteve. http://www.joesfer.com
+	This software is released under the LGPL-3.0 license: http://www.opensource.org/licenses/lgpl-3.0.html	
+	================================================================================
+*/
+
+#include "NearestNeighbors.h"
+#include <algorithm>
+#include <assert.h>
+#include <float.h>
+#include <math.h>
+#ifdef _WIN32
+#include <malloc.h>
+#else
+#include <alloca.h>
+#endif
+
+//////////////////////////////////////////////////////////////////////////
+// KdTree
+//////////////////////////////////////////////////////////////////////////
+
+struct KdTree::axisLess_t {
+	axisLess_t( const float* coords, unsigned int axis ) : coords( coords ), axis( axis ) {}
+	bool operator()( unsigned int a, unsigned int b ) const { return coords[ 3 * a + axis ] < coords[ 3 * b + axis ]; }
+	const float*				coords;
+	const unsigned int			axis;
+};
+
+bool KdTree::Init( const float* coords, size_t numPoints ) {
+	std::vector< unsigned int > indices( numPoints );
+	for( size_t i = 0; i < numPoints; i++ ) {
+		indices[ i ] = (unsigned int)i;
+	}
+
+	nodes.resize( 0 );
+	nodes.reserve( numPoints );
+	nodeOfPoint.resize( numPoints );
+	active.assign( numPoints, true );
+	root = numPoints > 0 ? Build( &indices[ 0 ], numPoints, UINT_MAX, coords ) : UINT_MAX;
+
+	return true;
+}
+
+unsigned int KdTree::Build( unsigned int* indices, size_t numIndices, unsigned int parent, const float* coords ) {
+	if ( numIndices == 0 ) {
+		return UINT_MAX;
+	}
+
+	// split along the largest dimension of the points bounds
+	float bmin[ 3 ] = { FLT_MAX, FLT_MAX, FLT_MAX };
+	float bmax[ 3 ] = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+	for( size_t i = 0; i < numIndices; i++ ) {
+		const float* p = &coords[ 3 * indices[ i ] ];
+		for( int j = 0; j < 3; j++ ) {
+			bmin[ j ] = std::min( bmin[ j ], p[ j ] );
+			bmax[ j ] = std::max( bmax[ j ], p[ j ] );
+		}
+	}
+	unsigned int axis = 0;
+	if ( bmax[ 1 ] - bmin[ 1 ] > bmax[ axis ] - bmin[ axis ] ) axis = 1;
+	if ( bmax[ 2 ] - bmin[ 2 ] > bmax[ axis ] - bmin[ axis ] ) axis = 2;
+
+	const size_t median = numIndices / 2;
+	std::nth_element( indices, indices + median, indices + numIndices, axisLess_t( coords, axis ) );
+
+	const unsigned int point = indices[ median ];
+	const unsigned int nodeIdx = (unsigned int)nodes.size();
+	node_t n;
+	n.pos[ 0 ]		= coords[ 3 * point + 0 ];
+	n.pos[ 1 ]		= coords[ 3 * point + 1 ];
+	n.pos[ 2 ]		= coords[ 3 * point + 2 ];
+	n.point			= point;
+	n.parent		= parent;
+	n.axis			= axis;
+	n.activeCount	= (unsigned int)numIndices;
+	nodes.push_back( n );
+	nodeOfPoint[ point ] = nodeIdx;
+
+	const unsigned int left = Build( indices, median, nodeIdx, coords );
+	const unsigned int right = Build( indices + median + 1, numIndices - median - 1, nodeIdx, coords );
+	nodes[ nodeIdx ].left = left;
+	nodes[ nodeIdx ].right = right;
+	return nodeIdx;
+}
+
+void KdTree::Deactivate( sampleIndex_t point ) {
+	if ( !active[ point ] ) {
+		return;
+	}
+	active[ point ] = false;
+	for( unsigned int node = nodeOfPoint[ point ]; node != UINT_MAX; node = nodes[ node ].parent ) {
+		assert( nodes[ node ].activeCount > 0 );
+		nodes[ node ].activeCount--;
+	}
+}
+
+size_t KdTree::Bytes() const {
+	return nodes.capacity() * sizeof( node_t ) + 
+		   nodeOfPoint.capacity() * sizeof( unsigned int ) + 
+		   active.capacity() / 8;
+}
+
+void KdTree::ActivateAll() {
+	active.assign( active.size(), true );
+	// children are always stored after their parent
+	for( size_t i = nodes.size(); i-- > 0; ) {
+		node_t& n = nodes[ i ];
+		n.activeCount = 1 + ( n.left != UINT_MAX ? nodes[ n.left ].activeCount : 0 ) + ( n.right != UINT_MAX ? nodes[ n.right ].activeCount : 0 );
+	}
+}
+
+size_t KdTree::NearestNeighbors( const vec3_t& pos, const float searchRadius, const int maxNeighbors, sampleIndex_t* result ) const {
+	if ( root == UINT_MAX || maxNeighbors <= 0 ) {
+		return 0;
+	}
+
+	const float p[ 3 ] = { (float)pos.x, (float)pos.y, (float)pos.z };
+	// max-heap holding the closest points found so far
+	neighbor_t* heap = (neighbor_t*)alloca( maxNeighbors * sizeof( neighbor_t ) );
+	size_t found = 0;
+	NearestNeighbors( root, p, searchRadius * searchRadius, (size_t)maxNeighbors, heap, found );
+
+	std::sort_heap( heap, heap + found );
+	for( size_t i = 0; i < found; i++ ) {
+		result[ i ] = heap[ i ].point;
+	}
+	return found;
+}
+
+void KdTree::NearestNeighbors( unsigned int node, const float* pos, const float maxSqDist, const size_t maxNeighbors, neighbor_t* heap, size_t& found ) const {
+	while( node != UINT_MAX ) {
+		const node_t& n = nodes[ node ];
+		if ( n.activeCount == 0 ) {
+			// nothing left in this subtree
+			return;
+		}
+
+		if ( active[ n.point ] ) {
+			const float dx = pos[ 0 ] - n.pos[ 0 ];
+			const float dy = pos[ 1 ] - n.pos[ 1 ];
+			const float dz = pos[ 2 ] - n.pos[ 2 ];
+			neighbor_t candidate;
+			candidate.sqDist = dx * dx + dy * dy + dz * dz;
+			candidate.point = n.point;
+			if ( candidate.sqDist <= maxSqDist ) {
+				if ( found < maxNeighbors ) {
+					heap[ found++ ] = candidate;
+					std::push_heap( heap, heap + found );
+				} else if ( candidate < heap[ 0 ] ) {
+					std::pop_heap( heap, heap + found );
+					heap[ found - 1 ] = candidate;
+					std::push_heap( heap, heap + found );
+				}
+			}
+		}
+
+		const float delta = pos[ n.axis ] - n.pos[ n.axis ];
+		const unsigned int nearChild = delta < 0 ? n.left : n.right;
+		const unsigned int farChild = delta < 0 ? n.right : n.left;
+		if ( farChild != UINT_MAX ) {
+			NearestNeighbors( nearChild, pos, maxSqDist, maxNeighbors, heap, found );
+			const float searchSqDist = found < maxNeighbors ? maxSqDist : heap[ 0 ].sqDist;
+			if ( delta * delta > searchSqDist ) {
+				return;
+			}
+			node = farChild;
+		} else {
+			node = nearChild;
+		}
+	}
+}
+
+size_t KdTree::PointsInRadius( const vec3_t& pos, const float searchRadius, std::vector< sampleIndex_t >& result ) const {
+	result.resize( 0 );
+	if ( root != UINT_MAX ) {
+		const float p[ 3 ] = { (float)pos.x, (float)pos.y, (float)pos.z };
+		PointsInRadius( root, p, searchRadius * searchRadius, result );
+	}
+	return result.size();
+}
+
+void KdTree::PointsInRadius( unsigned int node, const float* pos, const float sqRadius, std::vector< sampleIndex_t >& result ) const {
+	while( node != UINT_MAX ) {
+		const node_t& n = nodes[ node ];
+		if ( n.activeCount == 0 ) {
+			return;
+		}
+
+		if ( active[ n.point ] ) {
+			const float dx = pos[ 0 ] - n.pos[ 0 ];
+			const float dy = pos[ 1 ] - n.pos[ 1 ];
+			const float dz = pos[ 2 ] - n.pos[ 2 ];
+			if ( dx * dx + dy * dy + dz * dz <= sqRadius ) {
+				result.push_back( n.point );
+			}
+		}
+
+		const float delta = pos[ n.axis ] - n.pos[ n.axis ];
+		const unsigned int nearChild = delta < 0 ? n.left : n.right;
+		const unsigned int farChild = delta < 0 ? n.right : n.left;
+		if ( delta * delta <= sqRadius ) {
+			PointsInRadius( farChild, pos, sqRadius, result );
+		}
+		node = nearChild;
+	}
+}
+
+sampleIndex_t KdTree::Nearest( const vec3_t& pos, const float searchRadius ) const {
+	const float p[ 3 ] = { (float)pos.x, (float)pos.y, (float)pos.z };
+	// anything closer than the radius beats this one, and ties are resolved
+	// as NearestNeighbors does
+	neighbor_t nearest;
+	nearest.sqDist = searchRadius * searchRadius;
+	nearest.point = UINT_MAX;
+	Nearest( root, p, nearest );
+	return nearest.point;
+}
+
+void KdTree::Nearest( unsigned int node, const float* pos, neighbor_t& nearest ) const {
+	while( node != UINT_MAX ) {
+		const node_t& n = nodes[ node ];
+		const float dx = pos[ 0 ] - n.pos[ 0 ];
+		const float dy = pos[ 1 ] - n.pos[ 1 ];
+		const float dz = pos[ 2 ] - n.pos[ 2 ];
+		neighbor_t candidate;
+		candidate.sqDist = dx * dx + dy * dy + dz * dz;
+		candidate.point = n.point;
+		if ( candidate < nearest ) {
+			nearest = candidate;
+		}
+
+		const float delta = pos[ n.axis ] - n.pos[ n.axis ];
+		const unsigned int nearChild = delta < 0 ? n.left : n.right;
+		const unsigned int farChild = delta < 0 ? n.right : n.left;
+		if ( farChild != UINT_MAX ) {
+			Nearest( nearChild, pos, nearest );
+			if ( delta * delta > nearest.sqDist ) {
+				return;
+			}
+			node = farChild;
+		} else {
+			node = nearChild;
+		}
+	}
+}
+
+//////////////////////////////////////////////////////////////////////////
+// IncrementalKdTree
+//////////////////////////////////////////////////////////////////////////
+
+#define KDTREE_NULL_NODE	UINT_MAX
+
+// Insertions deeper than 2 log2( size ) rebuild the lowest subtree along
+// their path with a child holding more than KDTREE_BALANCE of its points
+// (one is guaranteed to exist as long as KDTREE_BALANCE < 1 / sqrt( 2 )).
+// The depth therefore stays around 2 log2( size ) levels, well under the
+// stack Nearest has room for.
+#define KDTREE_BALANCE		0.7
+#define KDTREE_MAX_DEPTH	128
+
+IncrementalKdTree::IncrementalKdTree() : root( KDTREE_NULL_NODE ) {}
+
+void IncrementalKdTree::Clear() {
+	nodes.resize( 0 );
+	root = KDTREE_NULL_NODE;
+}
+
+void IncrementalKdTree::Reserve( size_t numPoints ) {
+	nodes.reserve( numPoints );
+}
+
+size_t IncrementalKdTree::Insert( const vec3_t& pos ) {
+	const unsigned int idx = (unsigned int)nodes.size();
+
+	node_t newNode;
+	newNode.pos[ 0 ] = (float)pos.x;
+	newNode.pos[ 1 ] = (float)pos.y;
+	newNode.pos[ 2 ] = (float)pos.z;
+	newNode.left = newNode.right = KDTREE_NULL_NODE;
+	newNode.axis = 0;
+	nodes.push_back( newNode );
+
+	if ( root == KDTREE_NULL_NODE ) {
+		root = idx;
+		return idx;
+	}
+
+	// walk down to the leaf where the point belongs
+	path.resize( 0 );
+	unsigned int current = root;
+	for( ;; ) {
+		path.push_back( current );
+		node_t& n = nodes[ current ];
+		unsigned int& next = ( newNode.pos[ n.axis ] < n.pos[ n.axis ] ) ? n.left : n.right;
+		if ( next == KDTREE_NULL_NODE ) {
+			next = idx;
+			nodes[ idx ].axis = ( n.axis + 1 ) % 3;
+			break;
+		}
+		current = next;
+	}
+
+	// points are usually inserted in spatially coherent batches (nodes
+	// growing along a branch), which produce long chains in the tree. 
+	// If the new point went too deep, walk back up to the first ancestor
+	// with a child holding too many of its points and rebuild it, which 
+	// costs time proportional to that subtree only.
+	const size_t depth = path.size();
+	unsigned int log2Size = 0;
+	while( ( (size_t)1 << log2Size ) < nodes.size() ) log2Size++;
+	if ( depth > 2 * log2Size ) {
+		size_t childSize = 1;
+		unsigned int child = idx;
+		for( size_t i = depth; i-- > 0; ) {
+			node_t& n = nodes[ path[ i ] ];
+			const size_t size = childSize + 1 + SubtreeSize( n.left == child ? n.right : n.left );
+			if ( childSize > KDTREE_BALANCE * size || i == 0 ) {
+				// the root is rebuilt if no scapegoat is found, which can
+				// only happen because of rounding
+				unsigned int& link = i == 0 ? root : ( nodes[ path[ i - 1 ] ].left == path[ i ] ? nodes[ path[ i - 1 ] ].left : nodes[ path[ i - 1 ] ].right );
+				Rebuild( link, (unsigned int)i );
+				break;
+			}
+			childSize = size;
+			child = path[ i ];
+		}
+	}
+
+	return idx;
+}
+
+size_t IncrementalKdTree::SubtreeSize( unsigned int node ) {
+	if ( node == KDTREE_NULL_NODE ) {
+		return 0;
+	}
+	subtree.resize( 0 );
+	subtree.push_back( node );
+	for( size_t i = 0; i < subtree.size(); i++ ) {
+		const node_t& n = nodes[ subtree[ i ] ];
+		if ( n.left != KDTREE_NULL_NODE ) subtree.push_back( n.left );
+		if ( n.right != KDTREE_NULL_NODE ) subtree.push_back( n.right );
+	}
+	return subtree.size();
+}
+
+// Rebuilds a balanced subtree out of the points under node, which is at
+// the given depth of the tree and gets replaced by the new subtree root.
+void IncrementalKdTree::Rebuild( unsigned int& node, unsigned int depth ) {
+	SubtreeSize( node );
+	std::vector< unsigned int > indices( subtree );
+	node = Build( &indices[ 0 ], indices.size(), depth );
+}
+
+struct IncrementalKdTree::axisLess_t {
+	axisLess_t( const std::vector< node_t >& nodes, unsigned int axis ) : nodes( nodes ), axis( axis ) {}
+	bool operator()( unsigned int a, unsigned int b ) const { return nodes[ a ].pos[ axis ] < nodes[ b ].pos[ axis ]; }
+	const std::vector< node_t >&	nodes;
+	const unsigned int				axis;
+};
+
+unsigned int IncrementalKdTree::Build( unsigned int* indices, size_t numIndices, unsigned int depth ) {
+	if ( numIndices == 0 ) {
+		return KDTREE_NULL_NODE;
+	}
+
+	const unsigned int axis = depth % 3;
+	const size_t median = numIndices / 2;
+	std::nth_element( indices, indices + median, indices + numIndices, axisLess_t( nodes, axis ) );
+
+	// points equal to the median may end up on either side, Insert and
+	// Nearest only rely on the left ones not being greater and the right
+	// ones not being smaller. Splitting at the median position keeps the
+	// subtree balanced even with repeated coordinates.
+	const unsigned int nodeIdx = indices[ median ];
+	nodes[ nodeIdx ].axis = axis;
+	nodes[ nodeIdx ].left = Build( indices, median, depth + 1 );
+	nodes[ nodeIdx ].right = Build( indices + median + 1, numIndices - median - 1, depth + 1 );
+	return nodeIdx;
+}
+
+size_t IncrementalKdTree::Nearest( const vec3_t& pos, const float searchRadius, float& dist ) const {
+	const float p[ 3 ] = { (float)pos.x, (float)pos.y, (float)pos.z };
+	float bestSqDist = searchRadius * searchRadius;
+	size_t best = INVALID_INDEX;
+
+	// subtrees left to visit, along with the squared distance to their
+	// splitting plane. Each level of the tree pushes one at most.
+	unsigned int stackNodes[ KDTREE_MAX_DEPTH ];
+	float stackSqDist[ KDTREE_MAX_DEPTH ];
+	size_t stackSize = 0;
+	if ( root != KDTREE_NULL_NODE ) {
+		stackNodes[ 0 ] = root;
+		stackSqDist[ 0 ] = 0;
+		stackSize = 1;
+	}
+
+	while( stackSize > 0 ) {
+		stackSize--;
+		if ( stackSqDist[ stackSize ] > bestSqDist ) {
+			continue;
+		}
+		unsigned int node = stackNodes[ stackSize ];
+		while( node != KDTREE_NULL_NODE ) {
+			const node_t& n = nodes[ node ];
+
+			const float dx = p[ 0 ] - n.pos[ 0 ];
+			const float dy = p[ 1 ] - n.pos[ 1 ];
+			const float dz = p[ 2 ] - n.pos[ 2 ];
+			const float sqDist = dx * dx + dy * dy + dz * dz;
+			// favor the oldest point on ties so that the result doesn't depend 
+			// on the shape of the tree
+			if ( sqDist < bestSqDist || ( sqDist == bestSqDist && node < best ) ) {
+				bestSqDist = sqDist;
+				best = node;
+			}
+
+			// the near side first, so that the far one is pruned against the
+			// closest point found on it
+			const float delta = p[ n.axis ] - n.pos[ n.axis ];
+			const unsigned int nearChild = delta < 0 ? n.left : n.right;
+			const unsigned int farChild = delta < 0 ? n.right : n.left;
+			if ( farChild != KDTREE_NULL_NODE && delta * delta <= bestSqDist ) {
+				assert( stackSize < KDTREE_MAX_DEPTH );
+				stackNodes[ stackSize ] = farChild;
+				stackSqDist[ stackSize ] = delta * delta;
+				stackSize++;
+			}
+			node = nearChild;
+		}
+	}
+
+	dist = ( best != INVALID_INDEX ) ? sqrtf( bestSqDist ) : FLT_MAX;
+	return best;
+}
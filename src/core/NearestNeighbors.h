@@ -0,0 +1,131 @@
+/* 
+	================================================================================
+	Copyright (c) 2012, Jose Esteve. http://www.joesfer.com
+	This software is released under the LGPL-3.0 license: http://www.opensource.org/licenses/lgpl-3.0.html	
+	================================================================================
+*/
+
+#ifndef NearestNeighbors_h__
+#define NearestNeighbors_h__
+
+#include "Vector.h"
+#include <limits.h>
+#include <stddef.h>
+#include <vector>
+
+// index of a point within the set a tree was built from
+typedef unsigned int sampleIndex_t;
+
+/////////////////////////////////////////////////////////////////////
+//
+// class KdTree
+//
+//	Static kd-tree over a point set which supports deactivating points
+//	once built. Inactive points are skipped by the queries, and the 
+//	subtrees left without active points are pruned altogether, so the 
+//	queries get cheaper as the active set shrinks.
+// 
+/////////////////////////////////////////////////////////////////////
+
+class KdTree {
+public:
+	KdTree() : root( UINT_MAX ) {}
+
+	// builds the tree out of packed x, y, z coordinates
+	bool	Init( const float* coords, size_t numPoints );
+
+	// closest maxNeighbors active points within searchRadius, sorted by
+	// distance. Safe to call concurrently.
+	size_t	NearestNeighbors( const vec3_t& pos, const float searchRadius, const int maxNeighbors, sampleIndex_t* result ) const;
+	// every active point within searchRadius, unsorted. Safe to call concurrently.
+	size_t	PointsInRadius( const vec3_t& pos, const float searchRadius, std::vector< sampleIndex_t >& result ) const;
+	// closest point within searchRadius, whether active or not, or UINT_MAX
+	// if there's none. Safe to call concurrently.
+	sampleIndex_t	Nearest( const vec3_t& pos, const float searchRadius ) const;
+
+	void	Deactivate( sampleIndex_t point );
+	void	ActivateAll();
+	bool	IsActive( sampleIndex_t point ) const { return active[ point ]; }
+	size_t	NumActive() const { return root != UINT_MAX ? nodes[ root ].activeCount : 0; }
+	size_t	Size() const { return active.size(); }
+	size_t	Bytes() const;	// memory held by the tree
+
+private:
+	struct node_t {
+		float			pos[ 3 ];
+		unsigned int	point;
+		unsigned int	left;
+		unsigned int	right;
+		unsigned int	parent;
+		unsigned int	axis;
+		unsigned int	activeCount;	// active points in the subtree
+	};
+	struct neighbor_t {
+		float			sqDist;
+		sampleIndex_t	point;
+		bool operator<( const neighbor_t& other ) const { return sqDist < other.sqDist || ( sqDist == other.sqDist && point < other.point ); }
+	};
+	struct axisLess_t;
+
+	unsigned int	Build( unsigned int* indices, size_t numIndices, unsigned int parent, const float* coords );
+	void			NearestNeighbors( unsigned int node, const float* pos, const float maxSqDist, const size_t maxNeighbors, neighbor_t* heap, size_t& found ) const;
+	void			PointsInRadius( unsigned int node, const float* pos, const float sqRadius, std::vector< sampleIndex_t >& result ) const;
+	void			Nearest( unsigned int node, const float* pos, neighbor_t& nearest ) const;
+
+	std::vector< node_t >		nodes;			// preorder
+	std::vector< unsigned int >	nodeOfPoint;
+	std::vector< bool >			active;			// per point
+	unsigned int				root;
+};
+
+/////////////////////////////////////////////////////////////////////
+//
+// class IncrementalKdTree
+//
+//	Point kd-tree supporting insertions, used to index a growing set 
+//	of points (e.g. the grower nodes) without rebuilding the whole
+//	structure on every iteration. Points are identified by their 
+//	insertion order. The depth is kept logarithmic as in a scapegoat
+//	tree: whenever an insertion goes too deep, the subtree which got
+//	unbalanced along its path is rebuilt.
+// 
+/////////////////////////////////////////////////////////////////////
+
+class IncrementalKdTree {
+public:
+	IncrementalKdTree();
+
+	void	Clear();
+	void	Reserve( size_t numPoints );
+	size_t	Insert( const vec3_t& pos );
+	size_t	Size() const { return nodes.size(); }
+	size_t	Bytes() const { return nodes.capacity() * sizeof( node_t ); }	// memory held by the tree
+
+	// returns the index of the closest point within searchRadius, or
+	// INVALID_INDEX if there's none. Safe to call concurrently.
+	size_t	Nearest( const vec3_t& pos, const float searchRadius, float& dist ) const;
+
+	static const size_t INVALID_INDEX = (size_t)-1;
+
+private:
+	struct node_t {
+		float			pos[ 3 ];
+		unsigned int	left;
+		unsigned int	right;
+		unsigned int	axis;
+	};
+	struct axisLess_t;
+
+	size_t			SubtreeSize( unsigned int node );
+	void			Rebuild( unsigned int& node, unsigned int depth );
+	unsigned int	Build( unsigned int* indices, size_t numIndices, unsigned int depth );
+
+	std::vector< node_t >		nodes;	// node i holds the i-th inserted point
+	unsigned int				root;
+
+	// scratch storage for the insertions
+	std::vector< unsigned int >	path;
+	std::vector< unsigned int >	subtree;
+};
+
+#endif // NearestNeighbors_h__
\ No newline at end of file
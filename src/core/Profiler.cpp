@@ -0,0 +1,28 @@
+/* 
+	================================================================================
+	Copyright (c) 2012, Jose Esteve. http://www.joesfer.com
+	This software is released under the LGPL-3.0 license: http://www.opensource.org/licenses/lgpl-3.0.html	
+	================================================================================
+*/
+
+#include "Profiler.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/time.h>
+#include <stddef.h>
+#endif
+
+double ProfileSeconds() {
+#ifdef _WIN32
+	LARGE_INTEGER frequency, counter;
+	QueryPerformanceFrequency( &frequency );
+	QueryPerformanceCounter( &counter );
+	return (double)counter.QuadPart / (double)frequency.QuadPart;
+#else
+	timeval tv;
+	gettimeofday( &tv, NULL );
+	return tv.tv_sec + tv.tv_usec * 1e-6;
+#endif
+}
@@ -0,0 +1,15 @@
+/* 
+	================================================================================
+	Copyright (c) 2012, Jose Esteve. http://www.joesfer.com
+	This software is released under the LGPL-3.0 license: http://www.opensource.org/licenses/lgpl-3.0.html	
+	================================================================================
+*/
+
+#ifndef Profiler_h__
+#define Profiler_h__
+
+// Wall clock time in seconds, from an arbitrary origin. Only meant to
+// time stages by subtracting two readings.
+double ProfileSeconds();
+
+#endif // Profiler_h__
@@ -0,0 +1,42 @@
+/* 
+	================================================================================
+	Copyright (c) 2012, Jose Esteve. http://www.joesfer.com
+	This software is released under the LGPL-3.0 license: http://www.opensource.org/licenses/lgpl-3.0.html	
+	================================================================================
+*/
+
+#ifndef Random_h__
+#define Random_h__
+
+//////////////////////////////////////////////////////////////////////////
+//
+// Counter-based random numbers
+//
+//	Each value is a pure function of a seed, a counter (e.g. the index of
+//	the sample being generated) and a stream (which of the values drawn 
+//	for that counter). Values can therefore be generated in any order and
+//	on any number of threads, and are the same on every platform.
+//
+//////////////////////////////////////////////////////////////////////////
+
+// SplitMix64 finalizer
+inline unsigned long long RandomMix( unsigned long long x ) {
+	x ^= x >> 30;
+	x *= 0xbf58476d1ce4e5b9ULL;
+	x ^= x >> 27;
+	x *= 0x94d049bb133111ebULL;
+	x ^= x >> 31;
+	return x;
+}
+
+inline unsigned int RandomUInt( unsigned int seed, unsigned int counter, unsigned int stream ) {
+	const unsigned long long key = ( (unsigned long long)seed << 32 ) | counter;
+	return (unsigned int)( RandomMix( RandomMix( key ) + ( stream + 1 ) * 0x9e3779b97f4a7c15ULL ) >> 32 );
+}
+
+// Uniform float in [0, 1), using 24 bits so that the conversion is exact
+inline float RandomFloat( unsigned int seed, unsigned int counter, unsigned int stream ) {
+	return (float)( RandomUInt( seed, counter, stream ) >> 8 ) * ( 1.0f / 16777216.0f );
+}
+
+#endif // Random_h__
@@ -0,0 +1,59 @@
+/* 
+	================================================================================
+	Copyright (c) 2012, Jose Esteve. http://www.joesfer.com
+	This software is released under the LGPL-3.0 license: http://www.opensource.org/licenses/lgpl-3.0.html	
+	================================================================================
+*/
+
+#include "SamplePoints.h"
+#include "Hash.h"
+
+//////////////////////////////////////////////////////////////////////////
+// samplePoints_t
+//////////////////////////////////////////////////////////////////////////
+
+void samplePoints_t::Clear() {
+	positions.resize( 0 );
+	normals.resize( 0 );
+	bounds.Clear();
+	positionsHash = 0;
+}
+
+void samplePoints_t::Resize( size_t numSamples ) {
+	positions.resize( 3 * numSamples );
+	normals.resize( 3 * numSamples );
+}
+
+size_t samplePoints_t::Bytes() const {
+	return ( positions.capacity() + normals.capacity() ) * sizeof( float ) + index.Bytes();
+}
+
+//////////////////////////////////////////////////////////////////////////
+// samplePoints_t::Update
+//
+//	To be called once the samples are written. Hashes the positions and, 
+//	if requested, builds the kd-tree unless it was already built out of 
+//	the very same positions (e.g. the Sampler evaluated again but placed 
+//	the cached samples).
+//////////////////////////////////////////////////////////////////////////
+
+void samplePoints_t::Update( bool buildIndex ) {
+	const size_t numSamples = Size();
+
+	bounds.Clear();
+	for( size_t i = 0; i < numSamples; i++ ) {
+		bounds.Expand( Pos( i ) );
+	}
+
+	positionsHash = HashValue( HASH_SEED, numSamples );
+	if ( numSamples > 0 ) {
+		positionsHash = HashBytes( positionsHash, &positions[ 0 ], positions.size() * sizeof( float ) );
+	}
+	// 0 is kept for "no index"
+	positionsHash = positionsHash != 0 ? positionsHash : 1;
+
+	if ( buildIndex && !HasIndex() ) {
+		index.Init( numSamples > 0 ? &positions[ 0 ] : NULL, numSamples );
+		indexHash = positionsHash;
+	}
+}
@@ -0,0 +1,50 @@
+/* 
+	================================================================================
+	Copyright (c) 2012, Jose Esteve. http://www.joesfer.com
+	This software is released under the LGPL-3.0 license: http://www.opensource.org/licenses/lgpl-3.0.html	
+	================================================================================
+*/
+
+#ifndef SamplePoints_h__
+#define SamplePoints_h__
+
+#include "Vector.h"
+#include "NearestNeighbors.h"
+#include <stddef.h>
+#include <vector>
+
+/////////////////////////////////////////////////////////////////////
+//
+// struct samplePoints_t
+//
+//	The attraction points, stored as flat arrays of 3 floats per sample
+//	(the layout the kd-tree and the viewport consume directly) along with
+//	their bounds and a kd-tree over the positions. The tree is only built
+//	again by Update when the positions hash changes.
+//
+/////////////////////////////////////////////////////////////////////
+
+struct samplePoints_t {
+	samplePoints_t() : positionsHash( 0 ), indexHash( 0 ) {}
+
+	size_t			Size() const { return positions.size() / 3; }
+	void			Clear();
+	void			Resize( size_t numSamples );
+	void			Update( bool buildIndex );
+	bool			HasIndex() const { return indexHash != 0 && indexHash == positionsHash; }
+	size_t			Bytes() const;	// memory held by the samples and their index
+
+	vec3_t			Pos( size_t i ) const { return vec3_t( &positions[ 3 * i ] ); }
+	vec3_t			Normal( size_t i ) const { return vec3_t( &normals[ 3 * i ] ); }
+	void			SetPos( size_t i, const vec3_t& p ) { p.get( &positions[ 3 * i ] ); }
+	void			SetNormal( size_t i, const vec3_t& n ) { n.get( &normals[ 3 * i ] ); }
+
+	std::vector< float >	positions;
+	std::vector< float >	normals;
+	bounds_t				bounds;
+	unsigned long long		positionsHash;	// set by Update
+	unsigned long long		indexHash;		// positions hash the index was built from
+	KdTree					index;
+};
+
+#endif // SamplePoints_h__
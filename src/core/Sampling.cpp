@@ -0,0 +1,454 @@
+/* 
+	================================================================================
+	Copyright (c) 2012, Jose Esteve. http://www.joesfer.com
+	This software is released under the LGPL-3.0 license: http://www.opensource.org/licenses/lgpl-3.0.html	
+	================================================================================
+*/
+
+#include "Sampling.h"
+#include "Random.h"
+#include "NearestNeighbors.h"
+
+#include <math.h>
+#include <string.h>
+#include <algorithm>
+#include <queue>
+
+// Orders the cumulative distribution entries against a (non-normalised)
+// probability, used to binary search the sampled triangle.
+static bool TriangleCdfLess(const samplerCache_t::triSampling_t& tri, float r) {
+	return tri.cdf < r;
+}
+
+// Average vertex color lightness of a triangle, scales the sampling density
+static float TriangleLightness(const float* colors, int iA, int iB, int iC) {
+	const float* a = &colors[3 * iA];
+	const float* b = &colors[3 * iB];
+	const float* c = &colors[3 * iC];
+	const float third = 1.0f / 3.0f;
+	const float r = (a[0] + b[0] + c[0]) * third;
+	const float g = (a[1] + b[1] + c[1]) * third;
+	const float bl = (a[2] + b[2] + c[2]) * third;
+	return std::min(1.0f, std::max(0.f, (r + g + bl) * third));
+}
+
+//////////////////////////////////////////////////////////////////////////
+//
+// Parallel sample placement
+//
+//	Each task places a contiguous range of samples. The random numbers 
+//	of a sample only depend on the seed and the sample index, so the 
+//	result doesn't depend on how the samples are split.
+//
+//////////////////////////////////////////////////////////////////////////
+
+// random streams drawn for every sample
+enum sampleStream_e {
+	SS_TRIANGLE		= 0,
+	SS_BARYCENTRIC_U	= 1,
+	SS_BARYCENTRIC_V	= 2
+};
+
+struct sampleTask_t {
+	// inputs, shared among all the tasks
+	const int*												triangleVertices;
+	const float*											verts;		// 3 floats per vertex
+	const float*											vNormals;	// 3 floats per vertex
+	const std::vector< samplerCache_t::triSampling_t >*	triangleCdf;
+	const std::vector< float >*								rng;
+	std::vector< std::pair< float, float > >*				barycentricCoords;
+	bool													useSampleCache;
+	unsigned int											seed;
+	const unsigned int*										sampleIds; // sample placed at each output, NULL to place them all
+
+	// range of outputs [first, last) processed by this task
+	size_t													first;
+	size_t													last;
+
+	// outputs, 3 floats per sample
+	float*													points;
+	float*													normals;
+	std::vector< int >*										triangles; // optional
+};
+
+static void PlaceSamples(void* data) {
+	sampleTask_t* task = (sampleTask_t*)data;
+	const int* triangleVertices = task->triangleVertices;
+	const float* verts = task->verts;
+	const float* vNormals = task->vNormals;
+	const std::vector< samplerCache_t::triSampling_t >& triangleCdf = *task->triangleCdf;
+	std::vector< std::pair< float, float > >& barycentricCoords = *task->barycentricCoords;
+
+	const float maxTriangleCDF = triangleCdf[triangleCdf.size() - 1].cdf;
+	for (size_t i = task->first; i < task->last; i++) {
+		const size_t sample = task->sampleIds != NULL ? task->sampleIds[i] : i;
+		float r = (*task->rng)[sample] * maxTriangleCDF; // non-normalised CDF
+		// first triangle whose cdf reaches r
+		int triId = (int)(std::lower_bound(triangleCdf.begin(), triangleCdf.end(), r, TriangleCdfLess) - triangleCdf.begin());
+		triId = std::min(triId, (int)triangleCdf.size() - 1);
+
+		// sample using barycentric coordinates
+		float u, v;
+		if (task->useSampleCache)
+		{
+			u = barycentricCoords[sample].first;
+			v = barycentricCoords[sample].second;
+		}
+		else
+		{
+			// fold the points falling outside the triangle back in, which
+			// keeps the distribution uniform without rejection sampling
+			u = RandomFloat(task->seed, (unsigned int)sample, SS_BARYCENTRIC_U);
+			v = RandomFloat(task->seed, (unsigned int)sample, SS_BARYCENTRIC_V);
+			if (u + v > 1) {
+				u = 1.0f - u;
+				v = 1.0f - v;
+			}
+			barycentricCoords[sample] = std::pair<float, float>(u, v);
+		}
+		const int iA = triangleVertices[3 * triId + 0];
+		const int iB = triangleVertices[3 * triId + 1];
+		const int iC = triangleVertices[3 * triId + 2];
+		const vec3_t A( &verts[3 * iA] );
+		const vec3_t B( &verts[3 * iB] );
+		const vec3_t C( &verts[3 * iC] );
+	
+		const float w = 1.0f - u - v;
+		const vec3_t p = A * w + B * u + C * v;
+		task->points[3 * i + 0] = (float)p.x;
+		task->points[3 * i + 1] = (float)p.y;
+		task->points[3 * i + 2] = (float)p.z;
+	
+		// interpolated in single precision, normalized in double
+		const float* nA = &vNormals[3 * iA];
+		const float* nB = &vNormals[3 * iB];
+		const float* nC = &vNormals[3 * iC];
+		vec3_t n( nA[0] * w + nB[0] * u + nC[0] * v,
+				  nA[1] * w + nB[1] * u + nC[1] * v,
+				  nA[2] * w + nB[2] * u + nC[2] * v );
+		n.normalize();
+		task->normals[3 * i + 0] = (float)n.x;
+		task->normals[3 * i + 1] = (float)n.y;
+		task->normals[3 * i + 2] = (float)n.z;
+		if (task->triangles != NULL) {
+			(*task->triangles)[i] = triId;
+		}
+	}
+}
+
+// Places numOutputs samples, split in as many tasks as worth it
+static void RunPlacementTasks(const sampleTask_t& shared, size_t numOutputs, const TaskRunner& runner) {
+	const size_t minSamplesPerTask = 1024;
+	const size_t numTasks = NumTasks( runner, numOutputs, minSamplesPerTask );
+	const size_t samplesPerTask = ( numOutputs + numTasks - 1 ) / numTasks;
+
+	std::vector< sampleTask_t > tasks( numTasks, shared );
+	for (size_t i = 0; i < numTasks; i++) {
+		tasks[i].first	= std::min( numOutputs, i * samplesPerTask );
+		tasks[i].last	= std::min( numOutputs, tasks[i].first + samplesPerTask );
+	}
+	RunTasks( runner, PlaceSamples, tasks, numTasks );
+}
+
+//////////////////////////////////////////////////////////////////////////
+//
+// Poisson-disk sample elimination
+//
+//	Places a few times more candidates than requested, then removes one
+//	at a time the candidate most crowded by its neighbors until only the
+//	requested number remains (Yuksel 2015, "Sample Elimination for 
+//	Generating Poisson Disk Sample Sets"). The disk of each candidate is
+//	scaled by the vertex color importance of its triangle, so the sample
+//	density still follows it.
+//
+//////////////////////////////////////////////////////////////////////////
+
+#define POISSON_CANDIDATES_PER_SAMPLE	4
+
+struct eliminationNeighbor_t {
+	unsigned int	sample;
+	float			weight;
+};
+
+struct eliminationTask_t {
+	// inputs, shared among all the tasks
+	const KdTree*							knn;
+	const samplePoints_t*					candidates;
+	const std::vector< float >*				radius;
+	float									maxRadius;
+
+	// range of candidates [first, last) processed by this task
+	size_t									first;
+	size_t									last;
+
+	// per-task storage
+	std::vector< sampleIndex_t >			found;
+	std::vector< size_t >					neighborOffsets; // last - first + 1 entries into neighbors
+	std::vector< eliminationNeighbor_t >	neighbors;
+};
+
+static void FindEliminationNeighbors( void* data ) {
+	eliminationTask_t* task = (eliminationTask_t*)data;
+	const samplePoints_t& candidates = *task->candidates;
+	const std::vector< float >& radius = *task->radius;
+
+	task->neighborOffsets.resize( 0 );
+	task->neighbors.resize( 0 );
+	for( size_t i = task->first; i < task->last; i++ ) {
+		task->neighborOffsets.push_back( task->neighbors.size() );
+		const vec3_t pos = candidates.Pos( i );
+		task->knn->PointsInRadius( pos, radius[ i ] + task->maxRadius, task->found );
+		for( size_t j = 0; j < task->found.size(); j++ ) {
+			const unsigned int other = task->found[ j ];
+			if ( other == i ) continue;
+			const float dist = (float)pos.distanceTo( candidates.Pos( other ) );
+			const float diskDist = radius[ i ] + radius[ other ];
+			if ( dist >= diskDist ) continue;
+			float w = 1.0f - dist / diskDist;
+			w *= w; w *= w; w *= w; // ^8
+			eliminationNeighbor_t neighbor;
+			neighbor.sample = other;
+			neighbor.weight = w;
+			task->neighbors.push_back( neighbor );
+		}
+	}
+	task->neighborOffsets.push_back( task->neighbors.size() );
+}
+
+// Picks numSamples out of the candidates, returned in increasing order
+static void EliminateSamples( const samplePoints_t& candidates,
+							  const std::vector< float >& radius,
+							  size_t numSamples,
+							  const TaskRunner& runner,
+							  std::vector< unsigned int >& selected ) {
+	const size_t numCandidates = candidates.Size();
+
+	KdTree knn;
+	knn.Init( &candidates.positions[ 0 ], numCandidates );
+	float maxRadius = 0;
+	for( size_t i = 0; i < numCandidates; i++ ) {
+		maxRadius = std::max( maxRadius, radius[ i ] );
+	}
+
+	const size_t minCandidatesPerTask = 1024;
+	const size_t numTasks = NumTasks( runner, numCandidates, minCandidatesPerTask );
+	const size_t candidatesPerTask = ( numCandidates + numTasks - 1 ) / numTasks;
+	std::vector< eliminationTask_t > tasks( numTasks );
+	for( size_t i = 0; i < numTasks; i++ ) {
+		eliminationTask_t& task = tasks[ i ];
+		task.knn		= &knn;
+		task.candidates	= &candidates;
+		task.radius		= &radius;
+		task.maxRadius	= maxRadius;
+		task.first		= std::min( numCandidates, i * candidatesPerTask );
+		task.last		= std::min( numCandidates, task.first + candidatesPerTask );
+	}
+	RunTasks( runner, FindEliminationNeighbors, tasks, numTasks );
+
+	// weight of each candidate: how crowded it is by its neighbors
+	std::vector< float > weight( numCandidates, 0.f );
+	for( size_t t = 0; t < numTasks; t++ ) {
+		const eliminationTask_t& task = tasks[ t ];
+		for( size_t i = task.first; i < task.last; i++ ) {
+			for( size_t j = task.neighborOffsets[ i - task.first ]; j < task.neighborOffsets[ i - task.first + 1 ]; j++ ) {
+				weight[ i ] += task.neighbors[ j ].weight;
+			}
+		}
+	}
+
+	// remove the heaviest candidate and update its neighbors, the heap
+	// entries left stale by the updates are skipped when popped
+	std::priority_queue< std::pair< float, unsigned int > > heap;
+	for( size_t i = 0; i < numCandidates; i++ ) {
+		heap.push( std::make_pair( weight[ i ], (unsigned int)i ) );
+	}
+	std::vector< bool > removed( numCandidates, false );
+	size_t remaining = numCandidates;
+	while( remaining > numSamples && !heap.empty() ) {
+		const std::pair< float, unsigned int > top = heap.top();
+		heap.pop();
+		const unsigned int i = top.second;
+		if ( removed[ i ] || top.first != weight[ i ] ) continue;
+
+		removed[ i ] = true;
+		remaining--;
+		const eliminationTask_t& task = tasks[ i / candidatesPerTask ];
+		for( size_t j = task.neighborOffsets[ i - task.first ]; j < task.neighborOffsets[ i - task.first + 1 ]; j++ ) {
+			const eliminationNeighbor_t& neighbor = task.neighbors[ j ];
+			if ( removed[ neighbor.sample ] ) continue;
+			weight[ neighbor.sample ] -= neighbor.weight;
+			heap.push( std::make_pair( weight[ neighbor.sample ], neighbor.sample ) );
+		}
+	}
+
+	selected.resize( 0 );
+	for( size_t i = 0; i < numCandidates; i++ ) {
+		if ( !removed[ i ] ) {
+			selected.push_back( (unsigned int)i );
+		}
+	}
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+size_t samplerCache_t::Bytes() const {
+	return triangleIds.capacity() * sizeof( triSampling_t ) +
+		   triangleBarycentricCoords.capacity() * sizeof( std::pair< float, float > ) +
+		   randomNumbers.capacity() * sizeof( float ) +
+		   selectedSamples.capacity() * sizeof( unsigned int );
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+void SampleMesh(const triangleMesh_t& mesh,
+	int numSamples,
+	int randomSeed,
+	int sampleDistribution,
+	bool doCachePlacement,
+	samplerCache_t& cache,
+	samplePoints_t& samples,
+	const TaskRunner& runner) {
+	samples.Clear();
+
+	const float* vertexColors = mesh.colors;
+	const bool useVertexColor = vertexColors != NULL;
+
+	const int* triangleVertices = mesh.triangles;
+	unsigned int numTriangles = (unsigned int)mesh.numTriangles;
+
+	const float* vNormals = mesh.normals;
+	const float* verts = mesh.positions;
+
+	std::vector< samplerCache_t::triSampling_t >* pTriangleId = NULL;
+	std::vector< std::pair<float, float> >* pBarycentricCoord = NULL;
+	std::vector<float>* pRNG = NULL;
+
+	// the Poisson-disk distribution picks the samples out of a larger 
+	// set of random candidates
+	const bool poissonDisk = ( sampleDistribution == SD_POISSON_DISK );
+	const size_t numSelected = (size_t)std::max( numSamples, 0 );
+	const size_t numCandidates = poissonDisk ? numSelected * POISSON_CANDIDATES_PER_SAMPLE : numSelected;
+
+	bool useSampleCache = doCachePlacement && 
+						  cache.randomNumbers.size() == numCandidates &&
+						  cache.triangleIds.size() == numTriangles &&
+						  cache.seed == randomSeed &&
+						  cache.distribution == sampleDistribution &&
+						  ( !poissonDisk || cache.selectedSamples.size() == numSelected );
+	
+	if (useSampleCache)
+	{
+		pTriangleId = &cache.triangleIds;
+		pBarycentricCoord = &cache.triangleBarycentricCoords;
+		pRNG = &cache.randomNumbers;
+	}
+	else
+	{
+		// recompute sample placement
+
+		pTriangleId = &cache.triangleIds;
+		pBarycentricCoord = &cache.triangleBarycentricCoords;
+		pRNG = &cache.randomNumbers;
+	
+		(*pTriangleId).resize(numTriangles);
+		(*pBarycentricCoord).resize(numCandidates);
+		memset(&(*pBarycentricCoord)[0], 0, numCandidates * sizeof(std::pair<float, float>));
+
+		cache.seed = randomSeed;
+		cache.distribution = sampleDistribution;
+		cache.selectedSamples.resize(0);
+		pRNG->resize(numCandidates);
+		for (size_t i = 0; i < numCandidates; ++i)
+		{
+			(*pRNG)[i] = RandomFloat((unsigned int)randomSeed, (unsigned int)i, SS_TRIANGLE);
+		}
+
+		for (unsigned int i = 0; i < numTriangles; i++) {
+			const int iA = triangleVertices[3 * i + 0];
+			const int iB = triangleVertices[3 * i + 1];
+			const int iC = triangleVertices[3 * i + 2];
+			const vec3_t AB = vec3_t(&verts[3 * iB]) - vec3_t(&verts[3 * iA]);
+			const vec3_t AC = vec3_t(&verts[3 * iC]) - vec3_t(&verts[3 * iA]);
+			const float area = 0.5f * (float)(AB ^ AC).length();
+
+			float importance = area;
+			if (useVertexColor) {
+				importance *= TriangleLightness(vertexColors, iA, iB, iC);
+			}
+
+			(*pTriangleId)[i].triangle = i;
+			(*pTriangleId)[i].cdf = importance; // not a cdf yet
+		}
+
+		if (numTriangles == 0) {
+			return;
+		}
+
+		// cumulative probability distribution for faces
+		float cdf = 0.f;
+		for (size_t i = 0; i < numTriangles; ++i)
+		{
+			cdf +=  (*pTriangleId)[i].cdf;
+			(*pTriangleId)[i].cdf = cdf;
+		}
+	}
+
+
+	if (pTriangleId->empty() || numSamples <= 0) {
+		return;
+	}
+
+	// Sample triangles
+
+	sampleTask_t placement;
+	placement.triangleVertices	= triangleVertices;
+	placement.verts				= verts;
+	placement.vNormals			= vNormals;
+	placement.triangleCdf		= pTriangleId;
+	placement.rng				= pRNG;
+	placement.barycentricCoords	= pBarycentricCoord;
+	placement.useSampleCache	= useSampleCache;
+	placement.seed				= (unsigned int)randomSeed;
+	placement.sampleIds			= NULL;
+	placement.first				= 0;
+	placement.last				= 0;
+	placement.points			= NULL;
+	placement.normals			= NULL;
+	placement.triangles			= NULL;
+
+	if (poissonDisk && !useSampleCache) {
+		// place all the candidates, then keep the best spread ones
+		samplePoints_t candidates;
+		std::vector< int > candidateTriangles( numCandidates );
+		candidates.Resize(numCandidates);
+		placement.points	= &candidates.positions[0];
+		placement.normals	= &candidates.normals[0];
+		placement.triangles	= &candidateTriangles;
+		RunPlacementTasks(placement, numCandidates, runner);
+		placement.useSampleCache = true; // candidates are placed by now
+
+		// the disk radius giving numSamples samples over the (importance
+		// weighted) surface area, widened where the importance is low
+		const float importanceArea = (*pTriangleId)[pTriangleId->size() - 1].cdf;
+		const float baseRadius = sqrtf(importanceArea / (2.0f * sqrtf(3.0f) * numSamples));
+		std::vector< float > radius( numCandidates, baseRadius );
+		if (useVertexColor) {
+			for (size_t i = 0; i < numCandidates; i++) {
+				const int tri = candidateTriangles[i];
+				const float lightness = TriangleLightness(vertexColors, triangleVertices[3 * tri], triangleVertices[3 * tri + 1], triangleVertices[3 * tri + 2]);
+				radius[i] = baseRadius / sqrtf(std::max(lightness, 0.01f));
+			}
+		}
+
+		EliminateSamples(candidates, radius, numSamples, runner, cache.selectedSamples);
+		placement.triangles	= NULL;
+	}
+	if (poissonDisk) {
+		placement.sampleIds = &cache.selectedSamples[0];
+	}
+
+	samples.Resize(numSamples);
+	placement.points	= &samples.positions[0];
+	placement.normals	= &samples.normals[0];
+	RunPlacementTasks(placement, numSamples, runner);
+}
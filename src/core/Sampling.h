@@ -0,0 +1,83 @@
+/* 
+	================================================================================
+	Copyright (c) 2012, Jose Esteve. http://www.joesfer.com
+	This software is released under the LGPL-3.0 license: http://www.opensource.org/licenses/lgpl-3.0.html	
+	================================================================================
+*/
+
+#ifndef Sampling_h__
+#define Sampling_h__
+
+#include "SamplePoints.h"
+#include "TaskRunner.h"
+#include <stddef.h>
+#include <utility>
+#include <vector>
+
+//////////////////////////////////////////////////////////////////////////
+//
+// Mesh sampling
+//
+//	Scatters the attraction points over a triangle mesh, either as
+//	independent random samples or as an evenly spread (Poisson-disk) set.
+//	The sampling density follows the triangle areas, optionally scaled
+//	by the vertex color lightness.
+//
+//////////////////////////////////////////////////////////////////////////
+
+enum sampleDistribution_e {
+	SD_RANDOM			= 0,	// independent random samples
+	SD_POISSON_DISK		= 1		// evenly spread samples, picked by sample elimination
+};
+
+// Mesh to sample, the arrays are owned by the caller
+struct triangleMesh_t {
+	const float*	positions;		// 3 floats per vertex
+	const float*	normals;		// 3 floats per vertex
+	const float*	colors;			// 3 floats (r, g, b) per vertex, NULL to ignore
+	const int*		triangles;		// 3 vertex indices per triangle
+	size_t			numVertices;
+	size_t			numTriangles;
+};
+
+/////////////////////////////////////////////////////////////////////
+//
+// struct samplerCache_t
+//
+//	Placement of the samples over the mesh triangles, kept so that the
+//	samples stick to the surface while it deforms (as long as its
+//	topology, the seed and the distribution don't change).
+//
+/////////////////////////////////////////////////////////////////////
+
+struct samplerCache_t {
+	samplerCache_t() : seed( -1 ), distribution( -1 ) {}
+
+	size_t	Bytes() const;	// memory held by the cache
+
+	struct triSampling_t {
+		int triangle;
+		float cdf;
+	};
+
+	std::vector< triSampling_t > triangleIds;
+	std::vector< std::pair<float, float> > triangleBarycentricCoords;
+	std::vector<float> randomNumbers;
+	int seed; // seed randomNumbers and triangleBarycentricCoords were generated with
+	int distribution; // sampleDistribution_e
+	std::vector<unsigned int> selectedSamples; // Poisson-disk samples picked out of the random ones
+};
+
+// Places numSamples samples over the mesh. The placement is read from the
+// cache if doCachePlacement is set and it still applies, and stored into
+// it otherwise.
+void SampleMesh( const triangleMesh_t& mesh,
+				 int numSamples,
+				 int randomSeed,
+				 int sampleDistribution,
+				 bool doCachePlacement,
+				 samplerCache_t& cache,
+				 samplePoints_t& samples,
+				 const TaskRunner& runner );
+
+#endif // Sampling_h__
@@ -0,0 +1,63 @@
+/* 
+	================================================================================
+	Copyright (c) 2012, Jose Esteve. http://www.joesfer.com
+	This software is released under the LGPL-3.0 license: http://www.opensource.org/licenses/lgpl-3.0.html	
+	================================================================================
+*/
+
+#ifndef TaskRunner_h__
+#define TaskRunner_h__
+
+#include <stddef.h>
+#include <vector>
+
+//////////////////////////////////////////////////////////////////////////
+//
+// class TaskRunner
+//
+//	Runs a function over an array of task descriptions. The core
+//	algorithms split their work into tasks owning disjoint ranges of the
+//	output, so that the result doesn't depend on how (or whether) the
+//	tasks run in parallel. The base class runs them serially on the
+//	calling thread, hosts plug in their own thread pool (see
+//	MayaTaskRunner).
+//
+//////////////////////////////////////////////////////////////////////////
+
+typedef void ( *taskFunc_t )( void* task );
+
+class TaskRunner {
+public:
+	virtual			~TaskRunner() {}
+
+	// number of tasks worth splitting a workload into
+	virtual size_t	MaxTasks() const { return 1; }
+
+	// runs func over numTasks task descriptions laid out taskSize bytes
+	// apart, and returns once all of them are done
+	virtual void	Run( taskFunc_t func, void* tasks, size_t taskSize, size_t numTasks ) const {
+		for( size_t i = 0; i < numTasks; i++ ) {
+			func( (char*)tasks + i * taskSize );
+		}
+	}
+};
+
+// Runs the first numTasks tasks, on the calling thread if there's just one
+template< class T >
+void RunTasks( const TaskRunner& runner, taskFunc_t func, std::vector< T >& tasks, size_t numTasks ) {
+	if ( numTasks > 1 ) {
+		runner.Run( func, &tasks[ 0 ], sizeof( T ), numTasks );
+	} else if ( numTasks == 1 ) {
+		func( &tasks[ 0 ] );
+	}
+}
+
+// Number of tasks to split numItems items into, no fewer than
+// minItemsPerTask items each
+inline size_t NumTasks( const TaskRunner& runner, size_t numItems, size_t minItemsPerTask ) {
+	const size_t maxTasks = runner.MaxTasks() > 0 ? runner.MaxTasks() : 1;
+	const size_t numTasks = numItems / minItemsPerTask;
+	return numTasks < 1 ? 1 : ( numTasks < maxTasks ? numTasks : maxTasks );
+}
+
+#endif // TaskRunner_h__
@@ -0,0 +1,166 @@
+/* 
+	================================================================================
+	Copyright (c) 2012, Jose Esteve. http://www.joesfer.com
+	This software is released under the LGPL-3.0 license: http://www.opensource.org/licenses/lgpl-3.0.html	
+	================================================================================
+*/
+
+#include "Thickness.h"
+
+#include <float.h>
+#include <math.h>
+#include <algorithm>
+#include <vector>
+
+//////////////////////////////////////////////////////////////////////////
+//
+// Thickness remapping
+//
+//	The thickness curve comes baked into a lookup table, sampled at evenly
+//	spaced positions, so the remapping needs no access to the host's ramp.
+//
+//////////////////////////////////////////////////////////////////////////
+
+struct remapTask_t {
+	// inputs, shared among all the tasks
+	const float*	lut;			// THICKNESS_LUT_SIZE + 1 entries
+	float			minThickness;
+	float			maxThickness;
+	float			thicknessScale;
+
+	// range of nodes [first, last) processed by this task
+	size_t			first;
+	size_t			last;
+
+	// in/out
+	float*			thickness;
+};
+
+static void RemapThickness(void* data) {
+	const remapTask_t* task = (const remapTask_t*)data;
+	const float* lut = task->lut;
+	for (size_t i = task->first; i < task->last; i++) {
+		float normalizedThickness = (task->thickness[i] - task->minThickness) / (1e-8f + task->maxThickness - task->minThickness);
+		float inputThickness = normalizedThickness * task->thicknessScale;
+		// the 1.0f - X is because it's more intuitive to see the curve from thick to thin, instead of the natural order thin (0) to thick (1)
+		const float pos = std::max(0.f, std::min(1.f, 1.0f - inputThickness)) * THICKNESS_LUT_SIZE;
+		const int entry = std::min( (int)pos, THICKNESS_LUT_SIZE - 1 );
+		const float t = pos - entry;
+		task->thickness[i] = lut[ entry ] + ( lut[ entry + 1 ] - lut[ entry ] ) * t;
+	}
+}
+
+size_t CalculateThickness(const growerNodes_t& nodes, const float* lut, float thicknessScale, float* thicknessArray, const TaskRunner& runner) {
+	
+	// calculate branch thickness. This is a recursive process where 
+	// thickness( node_i ) = function( thickness( child0(node_i) ), thickness( child0(node_i) ), ... )
+	// Parents always precede their children in the node array, so rather
+	// than recursing, the nodes reachable from the root without crossing 
+	// a trimmed node are found in a forward sweep, and their thickness is
+	// computed in a single reverse sweep.
+
+	size_t activeNodes = 0;
+	const float baseThickness = 1.f;
+	const size_t numNodes = nodes.Size();
+
+	std::vector< unsigned char > reachable( numNodes, 0 );
+	for( size_t i = 0; i < numNodes; i++ ) {
+		const unsigned int parent = nodes.parent[ i ];
+		if ( parent == INVALID_PARENT ) {
+			reachable[ i ] = ( i == 0 );
+		} else {
+			reachable[ i ] = reachable[ parent ] && !nodes.trimmed[ parent ];
+		}
+	}
+
+	for( size_t node = numNodes; node-- > 0; ) {
+		if ( !reachable[ node ] ) {
+			thicknessArray[ node ] = 0;
+			continue;
+		}
+		const unsigned int numChildren = nodes.NumChildren( node );
+		if ( numChildren == 0 || nodes.trimmed[ node ] ) {
+			thicknessArray[ node ] = baseThickness;
+		} else {
+			float sqRadius = 0;
+			for( unsigned int i = 0; i < numChildren; i++ ) {
+				const float t = thicknessArray[ nodes.Child( node, i ) ];
+				sqRadius += t * t;
+			}
+			thicknessArray[ node ] = sqrtf( sqRadius );
+		}
+		if ( !nodes.trimmed[ node ] ) {
+			activeNodes++;
+		}
+	}
+
+	// now force the terminator nodes to have a thickness of 0 so they end in a spike
+	for( size_t i = 0; i < numNodes; i++ ) {
+		const unsigned int numChildren = nodes.NumChildren( i );
+		if ( reachable[ i ] && 
+			 ( numChildren == 0 || ( numChildren == 1 && nodes.trimmed[ nodes.Child( i, 0 ) ] ) ) ) {
+			thicknessArray[ i ] = 0.0001f;
+		}
+	}
+
+	// track down the bifurcations, for each single-child node path, interpolate
+	// the nodes thickness to smooth out appearance. Paths are walked once,
+	// from the node starting them.
+	for( size_t i = 0; i < numNodes; i++ ) {
+		const unsigned int parent = nodes.parent[ i ];
+		if ( nodes.NumChildren( i ) != 1 || 
+			 ( parent != INVALID_PARENT && nodes.NumChildren( parent ) == 1 ) ) {
+			continue;
+		}
+		size_t finish = i;
+		size_t pathLength = 0;
+		while( nodes.NumChildren( finish ) == 1 ) {
+			finish = nodes.Child( finish, 0 );
+			pathLength++;
+		}
+		if ( pathLength > 1 ) {
+			const float startThickness = thicknessArray[ i ];
+			const float finishThickness = thicknessArray[ finish ];
+			const float delta = ( finishThickness - startThickness ) / pathLength;
+			if ( delta < 0.001f ) {
+				// not worth it
+				continue;
+			}
+			// avoid reaching the node which numChildren != 1 (could be 0!)
+			size_t node = i;
+			for( size_t k = 0; k + 1 < pathLength; k++ ) {
+				thicknessArray[ node ] += delta * k;
+				node = nodes.Child( node, 0 );
+			}
+		}
+	}
+	
+	float maxThickness = 0;
+	float minThickness = FLT_MAX;
+	for (size_t i = 0; i < nodes.Size(); i++) {
+		const float thickness = thicknessArray[i];
+		maxThickness = std::max(maxThickness, thickness);
+		minThickness = std::min(minThickness, thickness);
+	}
+	minThickness = std::min(minThickness, maxThickness);
+	maxThickness = std::max(maxThickness, minThickness + 1e-8f);
+
+	const size_t minNodesPerTask = 4096;
+	const size_t numTasks = NumTasks( runner, nodes.Size(), minNodesPerTask );
+	const size_t nodesPerTask = ( nodes.Size() + numTasks - 1 ) / numTasks;
+
+	std::vector< remapTask_t > tasks( numTasks );
+	for( size_t i = 0; i < numTasks; i++ ) {
+		remapTask_t& task = tasks[ i ];
+		task.lut			= lut;
+		task.minThickness	= minThickness;
+		task.maxThickness	= maxThickness;
+		task.thicknessScale	= thicknessScale;
+		task.first			= std::min( nodes.Size(), i * nodesPerTask );
+		task.last			= std::min( nodes.Size(), task.first + nodesPerTask );
+		task.thickness		= thicknessArray;
+	}
+	RunTasks( runner, RemapThickness, tasks, numTasks );
+
+	return activeNodes;
+}
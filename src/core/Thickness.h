@@ -0,0 +1,28 @@
+/* 
+	================================================================================
+	Copyright (c) 2012, Jose Esteve. http://www.joesfer.com
+	This software is released under the LGPL-3.0 license: http://www.opensource.org/licenses/lgpl-3.0.html	
+	================================================================================
+*/
+
+#ifndef Thickness_h__
+#define Thickness_h__
+
+#include "GrowerNodes.h"
+#include "TaskRunner.h"
+#include <stddef.h>
+
+#define THICKNESS_LUT_SIZE	1024	// thickness ramp lookup table resolution
+
+// Calculates the branch thickness of every node, one float per node in
+// thicknessArray. The raw thickness is normalized, scaled by
+// thicknessScale and remapped through the lut, which holds a thickness
+// curve sampled at THICKNESS_LUT_SIZE + 1 evenly spaced positions.
+// Returns the number of active (reachable and not trimmed) nodes.
+size_t CalculateThickness( const growerNodes_t& nodes,
+						   const float* lut,
+						   float thicknessScale,
+						   float* thicknessArray,
+						   const TaskRunner& runner );
+
+#endif // Thickness_h__
@@ -0,0 +1,55 @@
+/* 
+	================================================================================
+	Copyright (c) 2012, Jose Esteve. http://www.joesfer.com
+	This software is released under the LGPL-3.0 license: http://www.opensource.org/licenses/lgpl-3.0.html	
+	================================================================================
+*/
+
+#include "Trimming.h"
+
+int GetMaxDepth( const growerNodes_t& nodes ) {
+	int depth = 0;
+	std::vector< size_t > nodeList[ 2 ];
+	nodeList[ 0 ].push_back( 0 );
+	while( !nodeList[ depth % 2 ].empty() ) {
+		std::vector< size_t >& activeNodes = nodeList[ depth % 2 ];
+		std::vector< size_t >& activeChildren = nodeList[ ( depth % 2 ) ^ 1 ];
+
+		activeChildren.resize( 0 );
+		for( size_t i = 0; i < activeNodes.size(); i++ ) {
+			const size_t node = activeNodes[ i ];
+			for( unsigned int j = 0; j < nodes.NumChildren( node ); j++ ) {
+				activeChildren.push_back( nodes.Child( node, j ) );
+			}
+		}
+
+		depth ++;		
+	}
+	return depth;
+}
+
+void Trim( growerNodes_t& nodes, const int maxLength ) {
+	size_t depth = 0;
+	std::vector< size_t > nodeList[ 2 ];
+	nodeList[ 0 ].push_back( 0 );
+	while( !nodeList[ depth % 2 ].empty() ) {
+		std::vector< size_t >& activeNodes = nodeList[ depth % 2 ];
+		std::vector< size_t >& activeChildren = nodeList[ ( depth % 2 ) ^ 1 ];
+
+		activeChildren.resize( 0 );
+		for( size_t i = 0; i < activeNodes.size(); i++ ) {
+			const size_t node = activeNodes[ i ];
+			nodes.trimmed[ node ] = ( depth == maxLength );
+			for( unsigned int j = 0; j < nodes.NumChildren( node ); j++ ) {
+				activeChildren.push_back( nodes.Child( node, j ) );
+			}
+		}
+
+		depth ++;
+		if ( depth > (size_t)maxLength ) {
+			// don't keep going deeper, the current active nodes have been marked as trimmed
+			// and will stop the meshing
+			break;
+		}
+	}
+}
@@ -0,0 +1,20 @@
+/* 
+	================================================================================
+	Copyright (c) 2012, Jose Esteve. http://www.joesfer.com
+	This software is released under the LGPL-3.0 license: http://www.opensource.org/licenses/lgpl-3.0.html	
+	================================================================================
+*/
+
+#ifndef Trimming_h__
+#define Trimming_h__
+
+#include "GrowerNodes.h"
+
+// Number of levels of the hierarchy below the root node, root included
+int		GetMaxDepth( const growerNodes_t& nodes );
+
+// Marks the nodes maxLength levels below the root as trimmed, which stops
+// the meshing there
+void	Trim( growerNodes_t& nodes, const int maxLength );
+
+#endif // Trimming_h__
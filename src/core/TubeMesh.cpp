@@ -0,0 +1,252 @@
+/* 
+	================================================================================
+	Copyright (c) 2012, Jose Esteve. http://www.joesfer.com
+	This software is released under the LGPL-3.0 license: http://www.opensource.org/licenses/lgpl-3.0.html	
+	================================================================================
+*/
+
+#include "TubeMesh.h"
+#include "Hash.h"
+
+#include <math.h>
+#include <string.h>
+#include <algorithm>
+
+#if defined( __SSE__ ) || defined( _M_X64 ) || ( defined( _M_IX86_FP ) && _M_IX86_FP >= 1 )
+#define GROWER_SSE	1
+#include <xmmintrin.h>
+#endif
+
+unsigned long long HashTopology( const growerNodes_t& nodes, const int tubeSections ) {
+	unsigned long long hash = HASH_SEED;
+	hash = HashValue( hash, tubeSections );
+	hash = HashValue( hash, nodes.Size() );
+	if ( nodes.Size() > 0 ) {
+		hash = HashBytes( hash, &nodes.parent[ 0 ], nodes.Size() * sizeof( unsigned int ) );
+		hash = HashBytes( hash, &nodes.trimmed[ 0 ], nodes.Size() * sizeof( unsigned char ) );
+	}
+	return hash;
+}
+
+void BuildTopology( const growerNodes_t& nodes, const int tubeSections, growerMeshTopology_t& topology ) {
+
+	topology.hash = HashTopology( nodes, tubeSections );
+	topology.tubeSections = tubeSections;
+	topology.numVertices = 0;
+	topology.numQuads = 0;
+	topology.vertexOffsets.resize( nodes.Size() );
+	topology.quadOffsets.resize( nodes.Size() );
+	if ( tubeSections <= 0 ) {
+		return;
+	}
+
+	// prefix sum over the vertices and quads of each node. A node is 
+	// trimmed if any of its ancestors is. By construction of the array, 
+	// parents are always processed before a child is, so we can rely on 
+	// the parent node's offset to have been set.
+	std::vector< int >& vertexOffsets = topology.vertexOffsets;
+	for( size_t i = 0; i < nodes.Size(); i++ ) {
+		const unsigned int parent = nodes.parent[ i ];
+		const bool trimmed = nodes.trimmed[ i ] != 0 || 
+							 ( parent != INVALID_PARENT && vertexOffsets[ parent ] == -1 );
+		if ( trimmed ) {
+			vertexOffsets[ i ] = -1;
+			continue;
+		}
+		vertexOffsets[ i ] = topology.numVertices;
+		topology.numVertices += tubeSections * std::max( 1u, nodes.NumChildren( i ) );
+		if ( parent != INVALID_PARENT ) {
+			// the root node has no quads (as we generate them towards it, but not from it)
+			topology.quadOffsets[ i ] = topology.numQuads;
+			topology.numQuads += tubeSections;
+		}
+	}
+}
+
+//////////////////////////////////////////////////////////////////////////
+//
+// Tube meshing tasks
+//
+//	Every active node gets one ring of tubeSections vertices per child (or
+//	a single ring if it's a leaf), and the ring of each child is joined to
+//	the matching ring of its parent with tubeSections quads. Vertex and 
+//	quad offsets are assigned up front by a prefix sum in node order, so 
+//	the tasks can fill disjoint ranges of the output buffers and the result
+//	does not depend on the number of tasks.
+//
+//////////////////////////////////////////////////////////////////////////
+
+// Writes the ring origin + thick * ( cos * ox + sin * oy ) for every entry
+// of the unit circle template, as tubeSections (x, y, z, 1) vertices.
+static void TransformRing( const float* ringCos, const float* ringSin, int tubeSections, 
+						   const float* origin, const float* ox, const float* oy, float thick, 
+						   float* vertices ) {
+	const float ax[ 3 ] = { thick * ox[ 0 ], thick * ox[ 1 ], thick * ox[ 2 ] };
+	const float ay[ 3 ] = { thick * oy[ 0 ], thick * oy[ 1 ], thick * oy[ 2 ] };
+	int j = 0;
+#if GROWER_SSE
+	// 4 vertices at a time, transposed from x/y/z/w lanes into vertices
+	const __m128 ax0 = _mm_set1_ps( ax[ 0 ] ), ax1 = _mm_set1_ps( ax[ 1 ] ), ax2 = _mm_set1_ps( ax[ 2 ] );
+	const __m128 ay0 = _mm_set1_ps( ay[ 0 ] ), ay1 = _mm_set1_ps( ay[ 1 ] ), ay2 = _mm_set1_ps( ay[ 2 ] );
+	const __m128 o0 = _mm_set1_ps( origin[ 0 ] ), o1 = _mm_set1_ps( origin[ 1 ] ), o2 = _mm_set1_ps( origin[ 2 ] );
+	for( ; j + 4 <= tubeSections; j += 4 ) {
+		const __m128 c = _mm_loadu_ps( ringCos + j );
+		const __m128 s = _mm_loadu_ps( ringSin + j );
+		__m128 x = _mm_add_ps( o0, _mm_add_ps( _mm_mul_ps( c, ax0 ), _mm_mul_ps( s, ay0 ) ) );
+		__m128 y = _mm_add_ps( o1, _mm_add_ps( _mm_mul_ps( c, ax1 ), _mm_mul_ps( s, ay1 ) ) );
+		__m128 z = _mm_add_ps( o2, _mm_add_ps( _mm_mul_ps( c, ax2 ), _mm_mul_ps( s, ay2 ) ) );
+		__m128 w = _mm_set1_ps( 1.0f );
+		_MM_TRANSPOSE4_PS( x, y, z, w );
+		_mm_storeu_ps( vertices + 4 * j, x );
+		_mm_storeu_ps( vertices + 4 * j + 4, y );
+		_mm_storeu_ps( vertices + 4 * j + 8, z );
+		_mm_storeu_ps( vertices + 4 * j + 12, w );
+	}
+#endif
+	for( ; j < tubeSections; j++ ) {
+		const float c = ringCos[ j ];
+		const float s = ringSin[ j ];
+		float* v = vertices + 4 * j;
+		v[ 0 ] = origin[ 0 ] + ( c * ax[ 0 ] + s * ay[ 0 ] );
+		v[ 1 ] = origin[ 1 ] + ( c * ax[ 1 ] + s * ay[ 1 ] );
+		v[ 2 ] = origin[ 2 ] + ( c * ax[ 2 ] + s * ay[ 2 ] );
+		v[ 3 ] = 1.0f;
+	}
+}
+
+struct meshTask_t {
+	// inputs, shared among all the tasks
+	const growerNodes_t*	nodes;
+	const float*			thickness;
+	const int*				vertexOffsets;	// -1 for trimmed nodes
+	const unsigned int*		quadOffsets;	// first quad joining each node to its parent
+	int						tubeSections;
+	const float*			ringCos;		// unit circle template, tubeSections entries
+	const float*			ringSin;
+
+	// range of nodes [first, last) processed by this task
+	size_t					first;
+	size_t					last;
+
+	// outputs
+	float*					vertices;		// 4 floats per vertex
+	int*					indices;		// 4 per quad, NULL to keep the previous ones
+};
+
+static void CreateTubeRings(void* data) {
+	const meshTask_t* task = (const meshTask_t*)data;
+	const growerNodes_t& nodes = *task->nodes;
+	const float* thickness = task->thickness;
+	const int tubeSections = task->tubeSections;
+
+	for( size_t i = task->first; i < task->last; i++ ) {
+		if ( task->vertexOffsets[ i ] == -1 ) {
+			continue;
+		}
+		const vec3_t pos = nodes.Pos( i );
+		const vec3_t surfaceNormal = nodes.Normal( i );
+		const unsigned int numChildren = nodes.NumChildren( i );
+		vec3_t axis;
+		if ( numChildren > 0 ) {
+			float largestThickness = 0;
+			for( unsigned int j = 0; j < numChildren; j++ ) {
+				const unsigned int child = nodes.Child( i, j );
+				if( thickness[ child ] > largestThickness ) {
+					largestThickness = thickness[ child ];
+					axis = nodes.Pos( child ) - pos;
+				}
+			}
+			axis.normalize();
+		} else if( nodes.parent[ i ] != INVALID_PARENT ) {
+			axis = pos - nodes.Pos( nodes.parent[ i ] );
+			axis.normalize();
+		} else {
+			// isolated node?
+			axis = vec3_t( 1, 0, 0 );
+		}
+
+		vec3_t ox, oy, oz;
+		oz = axis;
+		oz.normalize();
+		ox = oz ^ surfaceNormal;
+		oy = oz ^ ox;
+
+		const float thick = thickness [ i ];
+
+		const float fx[ 3 ] = { (float)ox.x, (float)ox.y, (float)ox.z };
+		const float fy[ 3 ] = { (float)oy.x, (float)oy.y, (float)oy.z };
+		const float origin[ 3 ] = { (float)( pos.x + surfaceNormal.x * thick ),
+									(float)( pos.y + surfaceNormal.y * thick ),
+									(float)( pos.z + surfaceNormal.z * thick ) };
+		float* v = task->vertices + 4 * task->vertexOffsets[ i ];
+		// every ring of the node is the same, transform one and copy it
+		TransformRing( task->ringCos, task->ringSin, tubeSections, origin, fx, fy, thick, v );
+		for( unsigned int k = 1; k < std::max( 1u, numChildren ); k++ ) {
+			memcpy( v + 4 * tubeSections * k, v, 4 * tubeSections * sizeof( float ) );
+		}
+
+		if ( task->indices == NULL ) {
+			continue;
+		}
+
+		// join the children rings to this node's
+		for( unsigned int k = 0; k < numChildren; k++ ) {
+			const unsigned int child = nodes.Child( i, k );
+			if ( task->vertexOffsets[ child ] == -1 ) {
+				continue;
+			}
+			const int vertexOffsetA = task->vertexOffsets[ i ] + tubeSections * k;
+			const int vertexOffsetB = task->vertexOffsets[ child ];
+			int* quad = task->indices + 4 * task->quadOffsets[ child ];
+			for( int j = 0; j < tubeSections; j++ ) {
+				*quad++ = vertexOffsetA + j;
+				*quad++ = vertexOffsetA + ( j + 1 ) % tubeSections;
+				*quad++ = vertexOffsetB + ( j + 1 ) % tubeSections;
+				*quad++ = vertexOffsetB + j;
+			}
+		}
+	}
+}
+
+void CreateMesh( const growerNodes_t& nodes, const growerMeshTopology_t& topology, const float* thickness, std::vector< float >& vertices, std::vector< int >* indices, const TaskRunner& runner ) {
+
+	vertices.resize( 4 * (size_t)topology.numVertices );
+	if ( indices != NULL ) {
+		indices->resize( 4 * (size_t)topology.numQuads );
+	}
+	if ( topology.numVertices == 0 ) {
+		return;
+	}
+
+	const int tubeSections = topology.tubeSections;
+
+	// unit circle shared by all the rings
+	std::vector< float > ringCos( tubeSections ), ringSin( tubeSections );
+	const float radStep = 2.0f * 3.141592f / tubeSections;
+	for( int j = 0; j < tubeSections; j++ ) {
+		const float angle = radStep * j;
+		ringCos[ j ] = cosf( angle );
+		ringSin[ j ] = sinf( angle );
+	}
+
+	const size_t minNodesPerTask = 1024;
+	const size_t numTasks = NumTasks( runner, nodes.Size(), minNodesPerTask );
+	const size_t nodesPerTask = ( nodes.Size() + numTasks - 1 ) / numTasks;
+
+	std::vector< meshTask_t > tasks( numTasks );
+	for( size_t i = 0; i < numTasks; i++ ) {
+		meshTask_t& task = tasks[ i ];
+		task.nodes			= &nodes;
+		task.thickness		= thickness;
+		task.vertexOffsets	= &topology.vertexOffsets[ 0 ];
+		task.quadOffsets	= &topology.quadOffsets[ 0 ];
+		task.tubeSections	= tubeSections;
+		task.ringCos		= &ringCos[ 0 ];
+		task.ringSin		= &ringSin[ 0 ];
+		task.first			= std::min( nodes.Size(), i * nodesPerTask );
+		task.last			= std::min( nodes.Size(), task.first + nodesPerTask );
+		task.vertices		= &vertices[ 0 ];
+		task.indices		= ( indices != NULL && !indices->empty() ) ? &( *indices )[ 0 ] : NULL;
+	}
+	RunTasks( runner, CreateTubeRings, tasks, numTasks );
+}
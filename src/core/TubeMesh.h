@@ -0,0 +1,45 @@
+/* 
+	================================================================================
+	Copyright (c) 2012, Jose Esteve. http://www.joesfer.com
+	This software is released under the LGPL-3.0 license: http://www.opensource.org/licenses/lgpl-3.0.html	
+	================================================================================
+*/
+
+#ifndef TubeMesh_h__
+#define TubeMesh_h__
+
+#include "GrowerNodes.h"
+#include "TaskRunner.h"
+#include <vector>
+
+// Connectivity of the tube mesh: each active node owns tubeSections
+// vertices per child (or a single ring if it's a leaf), starting at
+// vertexOffsets[ i ] (-1 if trimmed), and tubeSections quads joining it
+// to its parent, starting at quadOffsets[ i ].
+struct growerMeshTopology_t {
+	growerMeshTopology_t() : hash( 0 ), tubeSections( 0 ), numVertices( 0 ), numQuads( 0 ) {}
+
+	unsigned long long			hash;
+	int							tubeSections;
+	unsigned int				numVertices;
+	unsigned int				numQuads;
+	std::vector< int >			vertexOffsets;
+	std::vector< unsigned int >	quadOffsets;
+};
+
+// Identifies the mesh connectivity: the hierarchy, which nodes are
+// trimmed and the number of tube sections
+unsigned long long	HashTopology( const growerNodes_t& nodes, const int tubeSections );
+
+void				BuildTopology( const growerNodes_t& nodes, const int tubeSections, growerMeshTopology_t& topology );
+
+// Writes the tube vertices, 4 floats (x, y, z, w) per vertex, and if
+// given the quad indices, 4 per quad. thickness holds one float per node.
+void				CreateMesh( const growerNodes_t& nodes,
+								const growerMeshTopology_t& topology,
+								const float* thickness,
+								std::vector< float >& vertices,
+								std::vector< int >* indices,
+								const TaskRunner& runner );
+
+#endif // TubeMesh_h__
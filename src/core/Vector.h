@@ -0,0 +1,86 @@
+/* 
+	================================================================================
+	Copyright (c) 2012, Jose Esteve. http://www.joesfer.com
+	This software is released under the LGPL-3.0 license: http://www.opensource.org/licenses/lgpl-3.0.html	
+	================================================================================
+*/
+
+#ifndef Vector_h__
+#define Vector_h__
+
+#include <float.h>
+#include <math.h>
+
+/////////////////////////////////////////////////////////////////////
+//
+// struct vec3_t
+//
+//	Double precision point/vector used by the core algorithms. It follows
+//	the MPoint/MVector conventions the algorithms were written against
+//	(^ is the cross product and * the dot product) so that they produce
+//	the very same results they did inside the Maya nodes.
+//
+/////////////////////////////////////////////////////////////////////
+
+struct vec3_t {
+	vec3_t() : x( 0 ), y( 0 ), z( 0 ) {}
+	vec3_t( double x, double y, double z ) : x( x ), y( y ), z( z ) {}
+	explicit vec3_t( const float* v ) : x( v[ 0 ] ), y( v[ 1 ] ), z( v[ 2 ] ) {}
+
+	vec3_t	operator+( const vec3_t& v ) const { return vec3_t( x + v.x, y + v.y, z + v.z ); }
+	vec3_t	operator-( const vec3_t& v ) const { return vec3_t( x - v.x, y - v.y, z - v.z ); }
+	vec3_t	operator-() const { return vec3_t( -x, -y, -z ); }
+	vec3_t	operator*( double s ) const { return vec3_t( x * s, y * s, z * s ); }
+	vec3_t	operator/( double s ) const { return vec3_t( x / s, y / s, z / s ); }
+	vec3_t&	operator+=( const vec3_t& v ) { x += v.x; y += v.y; z += v.z; return *this; }
+	vec3_t&	operator-=( const vec3_t& v ) { x -= v.x; y -= v.y; z -= v.z; return *this; }
+	vec3_t&	operator*=( double s ) { x *= s; y *= s; z *= s; return *this; }
+	vec3_t&	operator/=( double s ) { x /= s; y /= s; z /= s; return *this; }
+
+	double	operator*( const vec3_t& v ) const { return x * v.x + y * v.y + z * v.z; }
+	vec3_t	operator^( const vec3_t& v ) const { return vec3_t( y * v.z - z * v.y, z * v.x - x * v.z, x * v.y - y * v.x ); }
+
+	double	length() const { return sqrt( x * x + y * y + z * z ); }
+	double	distanceTo( const vec3_t& p ) const { return ( *this - p ).length(); }
+	// leaves zero length vectors untouched
+	void	normalize() { const double l = length(); if ( l > 0 ) { x /= l; y /= l; z /= l; } }
+	bool	isEquivalent( const vec3_t& v, double tolerance ) const { return fabs( x - v.x ) <= tolerance && fabs( y - v.y ) <= tolerance && fabs( z - v.z ) <= tolerance; }
+
+	void	get( float* v ) const { v[ 0 ] = (float)x; v[ 1 ] = (float)y; v[ 2 ] = (float)z; }
+
+	double	x, y, z;
+};
+
+inline vec3_t operator*( double s, const vec3_t& v ) { return v * s; }
+
+/////////////////////////////////////////////////////////////////////
+//
+// struct bounds_t
+//
+//	Axis aligned bounding box, empty after Clear.
+//
+/////////////////////////////////////////////////////////////////////
+
+struct bounds_t {
+	bounds_t() { Clear(); }
+
+	void	Clear() { min = vec3_t( DBL_MAX, DBL_MAX, DBL_MAX ); max = vec3_t( -DBL_MAX, -DBL_MAX, -DBL_MAX ); }
+	bool	IsEmpty() const { return min.x > max.x; }
+	void	Expand( const vec3_t& p ) {
+		if ( p.x < min.x ) min.x = p.x;
+		if ( p.y < min.y ) min.y = p.y;
+		if ( p.z < min.z ) min.z = p.z;
+		if ( p.x > max.x ) max.x = p.x;
+		if ( p.y > max.y ) max.y = p.y;
+		if ( p.z > max.z ) max.z = p.z;
+	}
+
+	double	Width() const { return IsEmpty() ? 0 : max.x - min.x; }
+	double	Height() const { return IsEmpty() ? 0 : max.y - min.y; }
+	double	Depth() const { return IsEmpty() ? 0 : max.z - min.z; }
+
+	vec3_t	min;
+	vec3_t	max;
+};
+
+#endif // Vector_h__
@@ -10,12 +10,16 @@
 #include "TrimmerNode.h"
 #include "GrowerShape.h"
 #include "GrowerShapeUI.h"
+#include "GrowerSubSceneOverride.h"
 #include "GrowerData.h"
 #include "SamplerCacheData.h"
+#include "SampleData.h"
 #include "SamplePreviewShape.h"
 #include "SamplePreviewShapeUI.h"
+#include "GrowerStats.h"
 
 #include <maya/MFnPlugin.h>
+#include <maya/MDrawRegistry.h>
 
 MStatus initializePlugin( MObject obj )
 //
@@ -37,6 +41,12 @@ MStatus initializePlugin( MObject obj )
 		return status;
 	}
 
+	status = plugin.registerData(SampleData::typeName, SampleData::id, SampleData::creator, MPxData::kGeometryData);
+	if (!status) {
+		status.perror("registerData SampleData");
+		return status;
+	}
+
 	status = plugin.registerNode( "Sampler", Sampler::id, Sampler::creator, Sampler::initialize );
 	if (!status) {
 		status.perror("registerNode Sampler");
@@ -71,12 +81,21 @@ MStatus initializePlugin( MObject obj )
 								  GrowerShape::id, 
 								  GrowerShape::creator,
 								  GrowerShape::initialize, 
-								  GrowerShapeUI::creator );
+								  GrowerShapeUI::creator,
+								  &GrowerSubSceneOverride::drawDbClassification );
 	if (!status) {
 		status.perror("registerShape GrowerShape");
 		return status;
 	}
 
+	status = MHWRender::MDrawRegistry::registerSubSceneOverrideCreator( GrowerSubSceneOverride::drawDbClassification,
+																		GrowerSubSceneOverride::registrantId,
+																		GrowerSubSceneOverride::Creator );
+	if (!status) {
+		status.perror("registerSubSceneOverrideCreator GrowerSubSceneOverride");
+		return status;
+	}
+
 	status = plugin.registerData(SamplePreviewData::typeName, 
 								 SamplePreviewData::id, 
 								 SamplePreviewData::creator, 
@@ -95,6 +114,12 @@ MStatus initializePlugin( MObject obj )
 		status.perror("registerShape SampleShape");
 		return status;
 	}
+
+	status = plugin.registerCommand( GrowerStatsCmd::commandName, GrowerStatsCmd::creator, GrowerStatsCmd::syntax );
+	if (!status) {
+		status.perror("registerCommand growerStats");
+		return status;
+	}
 	
 	return status;
 }
@@ -112,6 +137,12 @@ MStatus uninitializePlugin( MObject obj)
 	MStatus   status;
 	MFnPlugin plugin( obj );
 
+	status = plugin.deregisterCommand( GrowerStatsCmd::commandName );
+	if (!status) {
+		status.perror("deregisterCommand");
+		return status;
+	}
+
 	status = plugin.deregisterNode( Sampler::id );
 	if (!status) {
 		status.perror("deregisterNode");
@@ -130,6 +161,12 @@ MStatus uninitializePlugin( MObject obj)
 		return status;
 	}
 
+	status = plugin.deregisterData(SampleData::id);
+	if (!status) {
+		status.perror("deregisterData");
+		return status;
+	}
+
 	status = plugin.deregisterNode( Grower::id );
 	if (!status) {
 		status.perror("deregisterNode");
@@ -142,6 +179,13 @@ MStatus uninitializePlugin( MObject obj)
 		return status;
 	}
 
+	status = MHWRender::MDrawRegistry::deregisterSubSceneOverrideCreator( GrowerSubSceneOverride::drawDbClassification,
+																		  GrowerSubSceneOverride::registrantId );
+	if (!status) {
+		status.perror("deregisterSubSceneOverrideCreator");
+		return status;
+	}
+
 	status = plugin.deregisterNode( GrowerShape::id );
 	if (!status) {
 		status.perror("deregisterNode");